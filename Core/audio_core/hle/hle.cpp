@@ -411,7 +411,15 @@ bool DspHle::Impl::Tick() {
 }
 
 void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
-    if (Tick()) {
+    auto& perf_stats = Core::System::GetInstance().perf_stats;
+    if (perf_stats) {
+        perf_stats->BeginDSPProcessing();
+    }
+    const bool signal = Tick();
+    if (perf_stats) {
+        perf_stats->EndDSPProcessing();
+    }
+    if (signal) {
         // TODO(merry): Signal all the other interrupts as appropriate.
         interrupt_handler(InterruptType::Pipe, DspPipe::Audio);
     }
@@ -11,6 +11,8 @@
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/gdbstub/gdbstub.h"
+#include "core/memory.h"
 
 namespace Core {
 
@@ -19,6 +21,7 @@ ARM_DynCom::ARM_DynCom(Core::System& system_, Memory::MemorySystem& memory,
                        std::shared_ptr<Core::Timing::Timer> timer)
     : ARM_Interface(id, timer), system(system_) {
     state = std::make_unique<ARMul_State>(system, memory, initial_mode);
+    state->core_id = id;
 }
 
 ARM_DynCom::~ARM_DynCom() {}
@@ -32,16 +35,44 @@ void ARM_DynCom::Step() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    if (system.IsCoreRunningConcurrently(*this)) {
+        std::scoped_lock lock{pending_mutex};
+        pending_changes.clear_cache = true;
+        has_pending_changes = true;
+        return;
+    }
+    state->instruction_cache.Clear();
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    if (system.IsCoreRunningConcurrently(*this)) {
+        std::scoped_lock lock{pending_mutex};
+        pending_changes.invalidated_ranges.emplace_back(start_address, length);
+        has_pending_changes = true;
+        return;
+    }
+    state->instruction_cache.Invalidate(start_address, length);
 }
 
 void ARM_DynCom::SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) {
-    ClearInstructionCache();
+    if (system.IsCoreRunningConcurrently(*this)) {
+        std::scoped_lock lock{pending_mutex};
+        pending_changes.page_table = page_table;
+        pending_changes.set_page_table = true;
+        has_pending_changes = true;
+        return;
+    }
+    UpdatePageTable(page_table);
+}
+
+void ARM_DynCom::UpdatePageTable(const std::shared_ptr<Memory::PageTable>& page_table) {
+    // The kernel sets the page table whenever it switches cores, which mostly keeps the table.
+    if (page_table == current_page_table) {
+        return;
+    }
+    current_page_table = page_table;
+    state->page_pointers = page_table ? page_table->GetPointerArray().data() : nullptr;
+    state->instruction_cache.Clear();
 }
 
 std::shared_ptr<Memory::PageTable> ARM_DynCom::GetPageTable() const {
@@ -96,11 +127,41 @@ void ARM_DynCom::SetCP15Register(CP15Register reg, u32 value) {
     state->CP15[reg] = value;
 }
 
+void ARM_DynCom::ApplyPendingChanges() {
+    PendingChanges changes;
+    {
+        std::scoped_lock lock{pending_mutex};
+        changes = std::exchange(pending_changes, {});
+        has_pending_changes = false;
+    }
+    if (changes.set_page_table) {
+        UpdatePageTable(changes.page_table);
+    }
+    if (changes.clear_cache) {
+        state->instruction_cache.Clear();
+        return;
+    }
+    for (const auto& [start_address, length] : changes.invalidated_ranges) {
+        state->instruction_cache.Invalidate(start_address, length);
+    }
+}
+
 void ARM_DynCom::ExecuteInstructions(u64 num_instructions) {
+    if (has_pending_changes) {
+        ApplyPendingChanges();
+    }
     state->NumInstrsToExecute = num_instructions;
+    state->check_memory_breakpoints = GDBStub::IsConnected();
+    state->reached_idle_loop = false;
     const u32 ticks_executed = InterpreterMainLoop(state.get());
     if (timer) {
+        const auto context_lock = system.LockCoreContext(GetID());
         timer->AddTicks(ticks_executed);
+        // Nothing the loop polls can change before the next event, so skip ahead to it.
+        if (state->reached_idle_loop && timer->GetDowncount() > 0) {
+            skipped_idle_cycles += timer->GetDowncount();
+            timer->Idle();
+        }
     }
     state->ServeBreak();
 }
@@ -125,4 +186,8 @@ void ARM_DynCom::PrepareReschedule() {
     state->NumInstrsToExecute = 0;
 }
 
+TranslationCache::Stats ARM_DynCom::GetTranslationCacheStats() const {
+    return state->instruction_cache.GetStats();
+}
+
 } // namespace Core
@@ -0,0 +1,204 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/arm/dyncom/arm_dyncom_cache.h"
+
+namespace {
+constexpr u32 CACHE_PAGE_BITS = 12;
+
+// Blocks are placed at this alignment so that they keep the alignment they were translated with.
+constexpr std::size_t BLOCK_ALIGNMENT = 16;
+} // namespace
+
+TranslationCache::TranslationCache(std::size_t capacity_)
+    : capacity{std::max(capacity_, CHUNK_SIZE)} {}
+
+TranslationCache::~TranslationCache() = default;
+
+char* TranslationCache::Insert(u32 addr, u32 end_addr, const char* code, std::size_t size) {
+    Drop(addr);
+
+    Block block = Allocate(size);
+    block.end_addr = end_addr;
+    std::memcpy(block.entry, code, size);
+
+    blocks.emplace(addr, block);
+    pages[addr >> CACHE_PAGE_BITS].push_back(addr);
+    used_bytes += block.size;
+    return block.entry;
+}
+
+void TranslationCache::Invalidate(u32 start_address, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    const u64 end_address = static_cast<u64>(start_address) + length;
+    const u32 first_page = start_address >> CACHE_PAGE_BITS;
+    const u32 last_page = static_cast<u32>((end_address - 1) >> CACHE_PAGE_BITS);
+    for (u32 page = first_page; page <= last_page; page++) {
+        const auto page_itr = pages.find(page);
+        if (page_itr == pages.end()) {
+            continue;
+        }
+
+        std::erase_if(page_itr->second, [&](u32 addr) {
+            const auto itr = blocks.find(addr);
+            if (addr >= end_address || itr->second.end_addr <= start_address) {
+                return false;
+            }
+            Release(addr, itr->second);
+            blocks.erase(itr);
+            return true;
+        });
+        if (page_itr->second.empty()) {
+            pages.erase(page_itr);
+        }
+    }
+}
+
+void TranslationCache::Clear() {
+    fast_lookup.fill({});
+    blocks.clear();
+    pages.clear();
+    for (auto& chunk : chunks) {
+        chunk.top = 0;
+        chunk.holes.clear();
+    }
+    current_chunk = 0;
+    used_bytes = 0;
+    generation++;
+}
+
+TranslationCache::Stats TranslationCache::GetStats() const {
+    return {
+        .capacity = capacity,
+        .reserved_bytes = chunks.size() * CHUNK_SIZE,
+        .used_bytes = used_bytes,
+        .num_blocks = blocks.size(),
+        .hits = hits,
+        .misses = misses,
+        .evictions = evictions,
+    };
+}
+
+TranslationCache::Block TranslationCache::Allocate(std::size_t size) {
+    size = Common::AlignUp(size, BLOCK_ALIGNMENT);
+    ASSERT_MSG(size <= CHUNK_SIZE, "Translated block of {} bytes exceeds the chunk size", size);
+
+    const auto place = [&](u32 index, std::size_t offset) {
+        return Block{chunks[index].data.get() + offset, size, 0, index};
+    };
+
+    // Prefer the space of dropped blocks, so that invalidation does not grow the cache.
+    for (u32 index = 0; index < chunks.size(); index++) {
+        auto& holes = chunks[index].holes;
+        const auto hole = std::find_if(holes.begin(), holes.end(),
+                                       [size](const auto& hole) { return hole.second >= size; });
+        if (hole == holes.end()) {
+            continue;
+        }
+        const auto [offset, hole_size] = *hole;
+        holes.erase(hole);
+        if (hole_size > size) {
+            holes.emplace(offset + size, hole_size - size);
+        }
+        return place(index, offset);
+    }
+
+    if (!chunks.empty() && chunks[current_chunk].top + size <= CHUNK_SIZE) {
+        const std::size_t offset = chunks[current_chunk].top;
+        chunks[current_chunk].top += size;
+        return place(current_chunk, offset);
+    }
+
+    if ((chunks.size() + 1) * CHUNK_SIZE <= capacity || chunks.empty()) {
+        chunks.push_back({.data = std::make_unique<char[]>(CHUNK_SIZE)});
+        current_chunk = static_cast<u32>(chunks.size() - 1);
+    } else {
+        // The chunk after the current one is the one that was filled the longest time ago.
+        current_chunk = static_cast<u32>((current_chunk + 1) % chunks.size());
+        if (chunks[current_chunk].top != 0) {
+            EvictChunk(current_chunk);
+        }
+    }
+    chunks[current_chunk].top = size;
+    return place(current_chunk, 0);
+}
+
+void TranslationCache::Release(u32 addr, const Block& block) {
+    used_bytes -= block.size;
+    generation++;
+
+    auto& fast_entry = fast_lookup[(addr >> 1) & (FAST_LOOKUP_SIZE - 1)];
+    if (fast_entry.addr == addr) {
+        fast_entry.entry = nullptr;
+    }
+
+    auto& chunk = chunks[block.chunk];
+    std::size_t offset = block.entry - chunk.data.get();
+    std::size_t size = block.size;
+
+    auto next = chunk.holes.lower_bound(offset);
+    if (next != chunk.holes.end() && offset + size == next->first) {
+        size += next->second;
+        next = chunk.holes.erase(next);
+    }
+    if (next != chunk.holes.begin()) {
+        const auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            chunk.holes.erase(prev);
+        }
+    }
+
+    if (offset + size == chunk.top) {
+        chunk.top = offset;
+    } else {
+        chunk.holes.emplace(offset, size);
+    }
+}
+
+void TranslationCache::Drop(u32 addr) {
+    const auto itr = blocks.find(addr);
+    if (itr == blocks.end()) {
+        return;
+    }
+    Release(addr, itr->second);
+    blocks.erase(itr);
+
+    const auto page_itr = pages.find(addr >> CACHE_PAGE_BITS);
+    std::erase(page_itr->second, addr);
+    if (page_itr->second.empty()) {
+        pages.erase(page_itr);
+    }
+}
+
+void TranslationCache::EvictChunk(u32 index) {
+    fast_lookup.fill({});
+    std::erase_if(blocks, [&](const auto& entry) {
+        if (entry.second.chunk != index) {
+            return false;
+        }
+        used_bytes -= entry.second.size;
+        return true;
+    });
+    for (auto itr = pages.begin(); itr != pages.end();) {
+        std::erase_if(itr->second, [&](u32 addr) { return !blocks.contains(addr); });
+        itr = itr->second.empty() ? pages.erase(itr) : std::next(itr);
+    }
+
+    chunks[index].top = 0;
+    chunks[index].holes.clear();
+    generation++;
+    evictions++;
+    LOG_DEBUG(Core_ARM11, "Evicted translation cache chunk {}, {} blocks remain", index,
+              blocks.size());
+}
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <vector>
 #include "core/arm/dyncom/arm_dyncom_dec.h"
 #include "core/arm/skyeye_common/armsupp.h"
 
@@ -440,64 +442,102 @@ const InstructionSetEncodingItem arm_exclusion_code[] = {
 };
 // clang-format on
 
-ARMDecodeStatus DecodeARMInstruction(u32 instr, int* idx) {
-    int n = 0;
-    int base = 0;
-    int instr_slots = sizeof(arm_instruction) / sizeof(InstructionSetEncodingItem);
-    ARMDecodeStatus ret = ARMDecodeStatus::FAILURE;
+namespace {
+constexpr int instr_slots = sizeof(arm_instruction) / sizeof(InstructionSetEncodingItem);
 
-    for (int i = 0; i < instr_slots; i++) {
-        n = arm_instruction[i].attribute_value;
-        base = 0;
+// The decoder buckets candidates by bits 27-20 and 7-4 of the instruction, which are the bits
+// the ARM encoding tables discriminate on.
+constexpr u32 DECODE_KEY_MASK = 0x0FF000F0;
+constexpr std::size_t NUM_DECODE_BUCKETS = 1 << 12;
 
-        // 3DS has no VFP3 support
-        if (arm_instruction[i].version == ARMVFP3)
-            continue;
+constexpr std::size_t GetDecodeBucket(u32 instr) {
+    return ((instr >> 16) & 0xFF0) | ((instr >> 4) & 0xF);
+}
 
-        while (n) {
-            if (arm_instruction[i].content[base + 1] == 31 &&
-                arm_instruction[i].content[base] == 0) {
-                // clrex
-                if (instr != arm_instruction[i].content[base + 2]) {
-                    break;
-                }
-            } else if (BITS(instr, arm_instruction[i].content[base],
-                            arm_instruction[i].content[base + 1]) !=
-                       arm_instruction[i].content[base + 2]) {
-                break;
+constexpr u32 GetBucketBits(std::size_t bucket) {
+    return static_cast<u32>(((bucket & 0xFF0) << 16) | ((bucket & 0xF) << 4));
+}
+
+/// Tests whether instr satisfies all bit-field constraints of the given table entry.
+bool MatchesEncoding(const InstructionSetEncodingItem& item, u32 instr) {
+    int base = 0;
+    for (int n = item.attribute_value; n > 0; n--, base += 3) {
+        if (item.content[base + 1] == 31 && item.content[base] == 0) {
+            // clrex
+            if (instr != item.content[base + 2]) {
+                return false;
             }
-            base += 3;
-            n--;
+        } else if (BITS(instr, item.content[base], item.content[base + 1]) !=
+                   item.content[base + 2]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Tests whether the constraints of the given table entry can hold for an instruction whose
+/// discriminating bits are bucket_bits.
+bool MayMatchBucket(const InstructionSetEncodingItem& item, u32 bucket_bits) {
+    int base = 0;
+    for (int n = item.attribute_value; n > 0; n--, base += 3) {
+        const u32 lo = item.content[base];
+        const u32 hi = item.content[base + 1];
+        const u32 field_mask = (hi - lo == 31) ? 0xFFFFFFFF : (((1u << (hi - lo + 1)) - 1) << lo);
+        const u32 expected = item.content[base + 2] << lo;
+        if (((bucket_bits ^ expected) & field_mask & DECODE_KEY_MASK) != 0) {
+            return false;
         }
+    }
+    return true;
+}
 
-        // All conditions are satisfied.
-        if (n == 0)
-            ret = ARMDecodeStatus::SUCCESS;
+/**
+ * Per-bucket lists of the arm_instruction entries that can match an instruction, kept in table
+ * order so that the first full match is the same one a linear scan of the table would find.
+ */
+struct DecodeTable {
+    std::array<u32, NUM_DECODE_BUCKETS + 1> bucket_start;
+    std::vector<u16> candidates;
 
-        if (ret == ARMDecodeStatus::SUCCESS) {
-            n = arm_exclusion_code[i].attribute_value;
-            if (n != 0) {
-                base = 0;
-                while (n) {
-                    if (BITS(instr, arm_exclusion_code[i].content[base],
-                             arm_exclusion_code[i].content[base + 1]) !=
-                        arm_exclusion_code[i].content[base + 2]) {
-                        break;
-                    }
-                    base += 3;
-                    n--;
+    DecodeTable() {
+        for (std::size_t bucket = 0; bucket < NUM_DECODE_BUCKETS; bucket++) {
+            bucket_start[bucket] = static_cast<u32>(candidates.size());
+            for (int i = 0; i < instr_slots; i++) {
+                // 3DS has no VFP3 support
+                if (arm_instruction[i].version == ARMVFP3) {
+                    continue;
+                }
+                if (MayMatchBucket(arm_instruction[i], GetBucketBits(bucket))) {
+                    candidates.push_back(static_cast<u16>(i));
                 }
-
-                // All conditions are satisfied.
-                if (n == 0)
-                    ret = ARMDecodeStatus::FAILURE;
             }
         }
+        bucket_start[NUM_DECODE_BUCKETS] = static_cast<u32>(candidates.size());
+    }
+};
+
+const DecodeTable& GetDecodeTable() {
+    static const DecodeTable table;
+    return table;
+}
+} // namespace
+
+ARMDecodeStatus DecodeARMInstruction(u32 instr, int* idx) {
+    const DecodeTable& table = GetDecodeTable();
+    const std::size_t bucket = GetDecodeBucket(instr);
 
-        if (ret == ARMDecodeStatus::SUCCESS) {
-            *idx = i;
-            return ret;
+    for (u32 c = table.bucket_start[bucket]; c < table.bucket_start[bucket + 1]; c++) {
+        const int i = table.candidates[c];
+        if (!MatchesEncoding(arm_instruction[i], instr)) {
+            continue;
+        }
+        // Entries whose exclusion rules hold are skipped in favour of later ones.
+        if (arm_exclusion_code[i].attribute_value != 0 &&
+            MatchesEncoding(arm_exclusion_code[i], instr)) {
+            continue;
         }
+        *idx = i;
+        return ARMDecodeStatus::SUCCESS;
     }
-    return ret;
+    return ARMDecodeStatus::FAILURE;
 }
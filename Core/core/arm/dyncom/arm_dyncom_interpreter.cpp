@@ -7,8 +7,10 @@
 #include <algorithm>
 #include <cstdio>
 #include "common/common_types.h"
+#include "common/hacks/hack_manager.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "core/arm/dyncom/arm_dyncom_dec.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
 #include "core/arm/dyncom/arm_dyncom_run.h"
@@ -20,6 +22,7 @@
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
 
@@ -33,7 +36,8 @@
 #define ROTATE_RIGHT_32(n, i) ROTATE_RIGHT(n, i, 32)
 #define ROTATE_LEFT_32(n, i) ROTATE_LEFT(n, i, 32)
 
-static bool CondPassed(const ARMul_State* cpu, unsigned int cond) {
+static bool CondPassed(ARMul_State* cpu, unsigned int cond) {
+    cpu->ResolveFlags();
     const bool n_flag = cpu->NFlag != 0;
     const bool z_flag = cpu->ZFlag != 0;
     const bool c_flag = cpu->CFlag != 0;
@@ -76,12 +80,16 @@ static bool CondPassed(const ARMul_State* cpu, unsigned int cond) {
     return false;
 }
 
+// Shifter carry out meaning the shift leaves the C flag unchanged. This avoids resolving deferred
+// flags for every register operand.
+constexpr unsigned int SHIFTER_CARRY_PRESERVED = 2;
+
 static unsigned int DPO(Immediate)(ARMul_State* cpu, unsigned int sht_oper) {
     unsigned int immed_8 = BITS(sht_oper, 0, 7);
     unsigned int rotate_imm = BITS(sht_oper, 8, 11);
     unsigned int shifter_operand = ROTATE_RIGHT_32(immed_8, rotate_imm * 2);
     if (rotate_imm == 0)
-        cpu->shifter_carry_out = cpu->CFlag;
+        cpu->shifter_carry_out = SHIFTER_CARRY_PRESERVED;
     else
         cpu->shifter_carry_out = BIT(shifter_operand, 31);
     return shifter_operand;
@@ -90,7 +98,7 @@ static unsigned int DPO(Immediate)(ARMul_State* cpu, unsigned int sht_oper) {
 static unsigned int DPO(Register)(ARMul_State* cpu, unsigned int sht_oper) {
     unsigned int rm = CHECK_READ_REG15(cpu, RM);
     unsigned int shifter_operand = rm;
-    cpu->shifter_carry_out = cpu->CFlag;
+    cpu->shifter_carry_out = SHIFTER_CARRY_PRESERVED;
     return shifter_operand;
 }
 
@@ -100,7 +108,7 @@ static unsigned int DPO(LogicalShiftLeftByImmediate)(ARMul_State* cpu, unsigned
     unsigned int shifter_operand;
     if (shift_imm == 0) {
         shifter_operand = rm;
-        cpu->shifter_carry_out = cpu->CFlag;
+        cpu->shifter_carry_out = SHIFTER_CARRY_PRESERVED;
     } else {
         shifter_operand = rm << shift_imm;
         cpu->shifter_carry_out = BIT(rm, 32 - shift_imm);
@@ -114,7 +122,7 @@ static unsigned int DPO(LogicalShiftLeftByRegister)(ARMul_State* cpu, unsigned i
     unsigned int rs = CHECK_READ_REG15(cpu, RS);
     if (BITS(rs, 0, 7) == 0) {
         shifter_operand = rm;
-        cpu->shifter_carry_out = cpu->CFlag;
+        cpu->shifter_carry_out = SHIFTER_CARRY_PRESERVED;
     } else if (BITS(rs, 0, 7) < 32) {
         shifter_operand = rm << BITS(rs, 0, 7);
         cpu->shifter_carry_out = BIT(rm, 32 - BITS(rs, 0, 7));
@@ -148,7 +156,7 @@ static unsigned int DPO(LogicalShiftRightByRegister)(ARMul_State* cpu, unsigned
     unsigned int shifter_operand;
     if (BITS(rs, 0, 7) == 0) {
         shifter_operand = rm;
-        cpu->shifter_carry_out = cpu->CFlag;
+        cpu->shifter_carry_out = SHIFTER_CARRY_PRESERVED;
     } else if (BITS(rs, 0, 7) < 32) {
         shifter_operand = rm >> BITS(rs, 0, 7);
         cpu->shifter_carry_out = BIT(rm, BITS(rs, 0, 7) - 1);
@@ -185,7 +193,7 @@ static unsigned int DPO(ArithmeticShiftRightByRegister)(ARMul_State* cpu, unsign
     unsigned int shifter_operand;
     if (BITS(rs, 0, 7) == 0) {
         shifter_operand = rm;
-        cpu->shifter_carry_out = cpu->CFlag;
+        cpu->shifter_carry_out = SHIFTER_CARRY_PRESERVED;
     } else if (BITS(rs, 0, 7) < 32) {
         shifter_operand = static_cast<int>(rm) >> BITS(rs, 0, 7);
         cpu->shifter_carry_out = BIT(rm, BITS(rs, 0, 7) - 1);
@@ -204,7 +212,7 @@ static unsigned int DPO(RotateRightByImmediate)(ARMul_State* cpu, unsigned int s
     unsigned int rm = CHECK_READ_REG15(cpu, RM);
     int shift_imm = BITS(sht_oper, 7, 11);
     if (shift_imm == 0) {
-        shifter_operand = (cpu->CFlag << 31) | (rm >> 1);
+        shifter_operand = (cpu->CarryFlag() << 31) | (rm >> 1);
         cpu->shifter_carry_out = BIT(rm, 0);
     } else {
         shifter_operand = ROTATE_RIGHT_32(rm, shift_imm);
@@ -219,7 +227,7 @@ static unsigned int DPO(RotateRightByRegister)(ARMul_State* cpu, unsigned int sh
     unsigned int shifter_operand;
     if (BITS(rs, 0, 7) == 0) {
         shifter_operand = rm;
-        cpu->shifter_carry_out = cpu->CFlag;
+        cpu->shifter_carry_out = SHIFTER_CARRY_PRESERVED;
     } else if (BITS(rs, 0, 4) == 0) {
         shifter_operand = rm;
         cpu->shifter_carry_out = BIT(rm, 31);
@@ -372,7 +380,7 @@ static void LnSWoUB(ScaledRegisterPreIndexed)(ARMul_State* cpu, unsigned int ins
         break;
     case 3:
         if (shift_imm == 0) {
-            index = (cpu->CFlag << 31) | (rm >> 1);
+            index = (cpu->CarryFlag() << 31) | (rm >> 1);
         } else {
             index = ROTATE_RIGHT_32(rm, shift_imm);
         }
@@ -423,7 +431,7 @@ static void LnSWoUB(ScaledRegisterPostIndexed)(ARMul_State* cpu, unsigned int in
         break;
     case 3:
         if (shift_imm == 0) {
-            index = (cpu->CFlag << 31) | (rm >> 1);
+            index = (cpu->CarryFlag() << 31) | (rm >> 1);
         } else {
             index = ROTATE_RIGHT_32(rm, shift_imm);
         }
@@ -648,7 +656,7 @@ static void LnSWoUB(ScaledRegisterOffset)(ARMul_State* cpu, unsigned int inst,
         break;
     case 3:
         if (shift_imm == 0) {
-            index = (cpu->CFlag << 31) | (rm >> 1);
+            index = (cpu->CarryFlag() << 31) | (rm >> 1);
         } else {
             index = ROTATE_RIGHT_32(rm, shift_imm);
         }
@@ -808,9 +816,9 @@ enum { KEEP_GOING, FETCH_EXCEPTION };
 MICROPROFILE_DEFINE(DynCom_Decode, "DynCom", "Decode", MP_RGB(255, 64, 64));
 
 static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, const u32 phys_addr,
-                                                    ARM_INST_PTR& inst_base) {
+                                                    ARM_INST_PTR& inst_base, u32& inst) {
     u32 inst_size = 4;
-    u32 inst = cpu->memory.Read32(phys_addr & 0xFFFFFFFC);
+    inst = cpu->memory.Read32(phys_addr & 0xFFFFFFFC);
 
     // If we are in Thumb mode, we'll translate one Thumb instruction to the corresponding ARM
     // instruction
@@ -821,6 +829,7 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
 
         // We have translated the Thumb branch instruction in the Thumb decoder
         if (state == ThumbDecodeStatus::BRANCH) {
+            inst = GetThumbInstruction(inst, phys_addr);
             return inst_size;
         }
         inst = arm_inst;
@@ -839,7 +848,297 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     return inst_size;
 }
 
-static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
+// Indices of the instructions fused by the peephole pass, matching their position in
+// arm_instruction_trans and InstLabel.
+enum : unsigned int {
+    SXTB_INST_INDEX = 42,
+    UXTB_INST_INDEX = 43,
+    SXTH_INST_INDEX = 44,
+    UXTH_INST_INDEX = 46,
+    CPY_INST_INDEX = 48,
+    CMP_INST_INDEX = 130,
+    TST_INST_INDEX = 131,
+    TEQ_INST_INDEX = 132,
+    CMN_INST_INDEX = 133,
+    AND_INST_INDEX = 144,
+    BIC_INST_INDEX = 145,
+    EOR_INST_INDEX = 147,
+    ADD_INST_INDEX = 148,
+    RSB_INST_INDEX = 149,
+    RSC_INST_INDEX = 150,
+    SBC_INST_INDEX = 151,
+    ADC_INST_INDEX = 152,
+    SUB_INST_INDEX = 153,
+    ORR_INST_INDEX = 154,
+    MVN_INST_INDEX = 155,
+    MOV_INST_INDEX = 156,
+    LDRSH_INST_INDEX = 159,
+    LDRSB_INST_INDEX = 162,
+    LDRH_INST_INDEX = 164,
+    LDRB_INST_INDEX = 178,
+    LDR_INST_INDEX = 180,
+    LDRCOND_INST_INDEX = 181,
+    NOP_INST_INDEX = 190,
+    YIELD_INST_INDEX = 191,
+    WFE_INST_INDEX = 192,
+    BBL_INST_INDEX = 196,
+    B_2_THUMB_INDEX = 197,
+    B_COND_THUMB_INDEX = 198,
+
+    // Superinstructions, placed after the special labels at the end of InstLabel
+    CMP_BRANCH_INDEX = 205,
+    TST_BRANCH_INDEX = 206,
+    CMN_BRANCH_INDEX = 207,
+};
+
+// Fuses a flag-setting compare with the conditional branch following it, so that both execute
+// with a single dispatch. The creams stay in place, only the index of the compare is changed.
+static void FuseInstructions(ARM_INST_PTR prev, ARM_INST_PTR inst) {
+    if (prev == nullptr || prev->cond != ConditionCode::AL) {
+        return;
+    }
+
+    bool conditional_branch = false;
+    if (inst->idx == BBL_INST_INDEX) {
+        const auto* const bbl = reinterpret_cast<const bbl_inst*>(inst->component);
+        conditional_branch = inst->cond != ConditionCode::AL && !bbl->L;
+    } else if (inst->idx == B_COND_THUMB_INDEX) {
+        conditional_branch = true;
+    }
+    if (!conditional_branch) {
+        return;
+    }
+
+    switch (prev->idx) {
+    case CMP_INST_INDEX:
+        prev->idx = CMP_BRANCH_INDEX;
+        break;
+    case TST_INST_INDEX:
+        prev->idx = TST_BRANCH_INDEX;
+        break;
+    case CMN_INST_INDEX:
+        prev->idx = CMN_BRANCH_INDEX;
+        break;
+    }
+}
+
+// Registers and flags accessed by the instructions of a block, used to find blocks which only poll
+// memory. Bits 0-14 are the general purpose registers, followed by the flags.
+struct IdleLoopAnalysis {
+    enum : u32 { FLAGS_NZ = 16, FLAG_C = 17, FLAG_V = 18 };
+
+    u32 read = 0;    ///< Registers read before being written in the block
+    u32 written = 0; ///< Registers written in the block
+    bool valid = true;
+
+    void Read(u32 reg) {
+        if (reg != 15 && !(written & (1U << reg))) {
+            read |= 1U << reg;
+        }
+    }
+
+    // A register that is written after being read carries state from one iteration to the
+    // next, so the loop would not do the same thing every time.
+    void Write(u32 reg) {
+        if (reg == 15 || (read & (1U << reg))) {
+            valid = false;
+        }
+        written |= 1U << reg;
+    }
+
+    void ReadCondition(u32 cond) {
+        switch (cond) {
+        case ConditionCode::EQ:
+        case ConditionCode::NE:
+        case ConditionCode::MI:
+        case ConditionCode::PL:
+            Read(FLAGS_NZ);
+            break;
+        case ConditionCode::CS:
+        case ConditionCode::CC:
+            Read(FLAG_C);
+            break;
+        case ConditionCode::VS:
+        case ConditionCode::VC:
+            Read(FLAG_V);
+            break;
+        case ConditionCode::HI:
+        case ConditionCode::LS:
+            Read(FLAGS_NZ);
+            Read(FLAG_C);
+            break;
+        case ConditionCode::GE:
+        case ConditionCode::LT:
+        case ConditionCode::GT:
+        case ConditionCode::LE:
+            Read(FLAGS_NZ);
+            Read(FLAG_V);
+            break;
+        }
+    }
+};
+
+// Records the registers accessed by a non-branch instruction. Only loads without writeback and
+// instructions that compute on registers are allowed in an idle loop.
+static void AnalyzeIdleLoopInstruction(IdleLoopAnalysis& analysis, unsigned int idx, u32 inst) {
+    const u32 cond = BITS(inst, 28, 31);
+    analysis.ReadCondition(cond);
+
+    // A conditional instruction leaves its destination unchanged when the condition fails.
+    const auto write = [&](u32 reg) {
+        if (cond != ConditionCode::AL) {
+            analysis.Read(reg);
+        }
+        analysis.Write(reg);
+    };
+
+    switch (idx) {
+    case CPY_INST_INDEX:
+    case CMP_INST_INDEX:
+    case TST_INST_INDEX:
+    case TEQ_INST_INDEX:
+    case CMN_INST_INDEX:
+    case AND_INST_INDEX:
+    case BIC_INST_INDEX:
+    case EOR_INST_INDEX:
+    case ADD_INST_INDEX:
+    case RSB_INST_INDEX:
+    case RSC_INST_INDEX:
+    case SBC_INST_INDEX:
+    case ADC_INST_INDEX:
+    case SUB_INST_INDEX:
+    case ORR_INST_INDEX:
+    case MVN_INST_INDEX:
+    case MOV_INST_INDEX: {
+        const u32 opcode = BITS(inst, 21, 24);
+        const bool arithmetic = (opcode >= 2 && opcode <= 7) || opcode == 10 || opcode == 11;
+        if (opcode != 13 && opcode != 15) {
+            analysis.Read(BITS(inst, 16, 19));
+        }
+        if (opcode >= 5 && opcode <= 7) {
+            analysis.Read(IdleLoopAnalysis::FLAG_C);
+        }
+
+        // Whether the shifter sets the carry always, never, or depending on a register.
+        bool shifter_carry = false;
+        bool shifter_carry_varies = false;
+        if (BIT(inst, 25)) {
+            shifter_carry = BITS(inst, 8, 11) != 0;
+        } else {
+            analysis.Read(BITS(inst, 0, 3));
+            if (BIT(inst, 4)) {
+                analysis.Read(BITS(inst, 8, 11));
+                shifter_carry_varies = true;
+            } else {
+                const u32 shift = BITS(inst, 5, 6);
+                const u32 shift_imm = BITS(inst, 7, 11);
+                if (shift == 3 && shift_imm == 0) {
+                    analysis.Read(IdleLoopAnalysis::FLAG_C);
+                }
+                shifter_carry = shift != 0 || shift_imm != 0;
+            }
+        }
+
+        if (BIT(inst, 20)) {
+            write(IdleLoopAnalysis::FLAGS_NZ);
+            if (arithmetic) {
+                write(IdleLoopAnalysis::FLAG_C);
+                write(IdleLoopAnalysis::FLAG_V);
+            } else if (shifter_carry_varies) {
+                analysis.Read(IdleLoopAnalysis::FLAG_C);
+                analysis.Write(IdleLoopAnalysis::FLAG_C);
+            } else if (shifter_carry) {
+                write(IdleLoopAnalysis::FLAG_C);
+            }
+        }
+        if (opcode < 8 || opcode > 11) {
+            write(BITS(inst, 12, 15));
+        }
+        break;
+    }
+    case LDR_INST_INDEX:
+    case LDRCOND_INST_INDEX:
+    case LDRB_INST_INDEX:
+        if (!BIT(inst, 24) || BIT(inst, 21)) {
+            analysis.valid = false;
+            break;
+        }
+        analysis.Read(BITS(inst, 16, 19));
+        if (BIT(inst, 25)) {
+            analysis.Read(BITS(inst, 0, 3));
+            if (BITS(inst, 5, 6) == 3 && BITS(inst, 7, 11) == 0) {
+                analysis.Read(IdleLoopAnalysis::FLAG_C);
+            }
+        }
+        write(BITS(inst, 12, 15));
+        break;
+    case LDRH_INST_INDEX:
+    case LDRSH_INST_INDEX:
+    case LDRSB_INST_INDEX:
+        if (!BIT(inst, 24) || BIT(inst, 21)) {
+            analysis.valid = false;
+            break;
+        }
+        analysis.Read(BITS(inst, 16, 19));
+        if (!BIT(inst, 22)) {
+            analysis.Read(BITS(inst, 0, 3));
+        }
+        write(BITS(inst, 12, 15));
+        break;
+    case SXTB_INST_INDEX:
+    case UXTB_INST_INDEX:
+    case SXTH_INST_INDEX:
+    case UXTH_INST_INDEX:
+        analysis.Read(BITS(inst, 0, 3));
+        write(BITS(inst, 12, 15));
+        break;
+    case NOP_INST_INDEX:
+    case YIELD_INST_INDEX:
+    case WFE_INST_INDEX:
+        break;
+    default:
+        analysis.valid = false;
+        break;
+    }
+}
+
+// Marks the branch ending a block as the end of an idle loop if it jumps back to the start of the
+// block and the block does the same thing on every iteration until memory changes.
+static void MarkIdleLoop(IdleLoopAnalysis& analysis, ARM_INST_PTR branch, u32 branch_addr,
+                         u32 block_start) {
+    if (branch->idx == BBL_INST_INDEX) {
+        auto* const inst_cream = reinterpret_cast<bbl_inst*>(branch->component);
+        analysis.ReadCondition(branch->cond);
+        if (analysis.valid && !inst_cream->L &&
+            branch_addr + 8 + inst_cream->signed_immed_24 == block_start) {
+            inst_cream->idle_loop = true;
+        }
+    } else if (branch->idx == B_2_THUMB_INDEX) {
+        auto* const inst_cream = reinterpret_cast<b_2_thumb*>(branch->component);
+        if (analysis.valid && branch_addr + 4 + inst_cream->imm == block_start) {
+            inst_cream->idle_loop = true;
+        }
+    } else if (branch->idx == B_COND_THUMB_INDEX) {
+        auto* const inst_cream = reinterpret_cast<b_cond_thumb*>(branch->component);
+        analysis.ReadCondition(inst_cream->cond);
+        if (analysis.valid && branch_addr + 4 + inst_cream->imm == block_start) {
+            inst_cream->idle_loop = true;
+        }
+    }
+}
+
+// Whether idle loops of the running title may be skipped.
+static bool IsIdleLoopSkipAllowed(const ARMul_State* cpu) {
+    if (!Settings::values.skip_idle_loops.GetValue()) {
+        return false;
+    }
+    const auto process = cpu->system.Kernel().GetCurrentProcess();
+    const u64 program_id = process ? process->codeset->program_id : 0;
+    return Common::Hacks::hack_manager.OverrideBooleanSetting(
+        Common::Hacks::HackType::SKIP_IDLE_LOOPS, program_id, true);
+}
+
+static int InterpreterTranslateBlock(ARMul_State* cpu, char*& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     // Decode instruction, get index
@@ -847,43 +1146,62 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
     // Go on next, until terminal instruction
     // Save start addr of basicblock in CreamCache
     ARM_INST_PTR inst_base = nullptr;
+    ARM_INST_PTR prev_inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
-    bb_start = trans_cache_buf_top;
+    const char* staged = BeginTransBlock();
+
+    // Fused instructions skip the breakpoint check of their second half.
+    const bool fuse = !GDBStub::IsServerEnabled();
+    IdleLoopAnalysis idle_loop_analysis;
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
 
     while (ret == TransExtData::NON_BRANCH) {
-        u32 inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+        u32 inst;
+        u32 inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base, inst);
+        if (inst_base->br == TransExtData::NON_BRANCH) {
+            AnalyzeIdleLoopInstruction(idle_loop_analysis, inst_base->idx, inst);
+        } else if (idle_loop_analysis.valid && !GDBStub::IsServerEnabled() &&
+                   IsIdleLoopSkipAllowed(cpu)) {
+            MarkIdleLoop(idle_loop_analysis, inst_base, phys_addr, pc_start);
+        }
         phys_addr += inst_size;
 
+        if (fuse) {
+            FuseInstructions(prev_inst_base, inst_base);
+        }
+        prev_inst_base = inst_base;
+
         if ((phys_addr & 0xfff) == 0) {
             inst_base->br = TransExtData::END_OF_PAGE;
         }
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    bb_start = cpu->instruction_cache.Insert(pc_start, phys_addr, staged, GetTransBlockSize());
 
     return KEEP_GOING;
 }
 
-static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u32 addr) {
+static int InterpreterTranslateSingle(ARMul_State* cpu, char*& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = trans_cache_buf_top;
+    const char* staged = BeginTransBlock();
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
 
-    InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+    u32 inst;
+    const u32 inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base, inst);
 
     if (inst_base->br == TransExtData::NON_BRANCH) {
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    bb_start = cpu->instruction_cache.Insert(pc_start, phys_addr + inst_size, staged,
+                                             GetTransBlockSize());
 
     return KEEP_GOING;
 }
@@ -943,7 +1261,7 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 #define FETCH_INST                                                                                 \
     if (inst_base->br != TransExtData::NON_BRANCH)                                                 \
         goto DISPATCH;                                                                             \
-    inst_base = (arm_inst*)&trans_cache_buf[ptr]
+    inst_base = (arm_inst*)ptr
 
 #define INC_PC(l) ptr += sizeof(arm_inst) + l
 #define INC_PC_STUB ptr += sizeof(arm_inst)
@@ -1391,17 +1709,28 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
         goto INIT_INST_LENGTH;                                                                     \
     case 204:                                                                                      \
         goto END;                                                                                  \
+    case 205:                                                                                      \
+        goto CMP_BRANCH_INST;                                                                      \
+    case 206:                                                                                      \
+        goto TST_BRANCH_INST;                                                                      \
+    case 207:                                                                                      \
+        goto CMN_BRANCH_INST;                                                                      \
     }
 #endif
 
-#define UPDATE_NFLAG(dst) (cpu->NFlag = BIT(dst, 31) ? 1 : 0)
-#define UPDATE_ZFLAG(dst) (cpu->ZFlag = dst ? 0 : 1)
-#define UPDATE_CFLAG_WITH_SC (cpu->CFlag = cpu->shifter_carry_out)
+#define UPDATE_NFLAG(dst) (cpu->ResolveFlags(), cpu->NFlag = BIT(dst, 31) ? 1 : 0)
+#define UPDATE_ZFLAG(dst) (cpu->ResolveFlags(), cpu->ZFlag = dst ? 0 : 1)
+#define UPDATE_CFLAG_WITH_SC                                                                       \
+    (cpu->ResolveFlags(),                                                                          \
+     cpu->CFlag = cpu->shifter_carry_out == SHIFTER_CARRY_PRESERVED ? cpu->CFlag                   \
+                                                                    : cpu->shifter_carry_out)
 
 #define SAVE_NZCVT                                                                                 \
+    cpu->ResolveFlags();                                                                           \
     cpu->Cpsr = (cpu->Cpsr & 0x0fffffdf) | (cpu->NFlag << 31) | (cpu->ZFlag << 30) |               \
                 (cpu->CFlag << 29) | (cpu->VFlag << 28) | (cpu->TFlag << 5)
 #define LOAD_NZCVT                                                                                 \
+    cpu->flags_pending = false;                                                                    \
     cpu->NFlag = (cpu->Cpsr >> 31);                                                                \
     cpu->ZFlag = (cpu->Cpsr >> 30) & 1;                                                            \
     cpu->CFlag = (cpu->Cpsr >> 29) & 1;                                                            \
@@ -1618,13 +1947,22 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
                          &&BLX_1_THUMB,
                          &&DISPATCH,
                          &&INIT_INST_LENGTH,
-                         &&END};
+                         &&END,
+                         &&CMP_BRANCH_INST,
+                         &&TST_BRANCH_INST,
+                         &&CMN_BRANCH_INST};
 #endif
     arm_inst* inst_base;
     unsigned int addr;
     unsigned int num_instrs = 0;
 
-    std::size_t ptr;
+    char* ptr;
+
+    // Link slot of the direct branch that ended the previous block, and the cache generation at
+    // the time that block was entered. The link may only be written while the generation is
+    // unchanged, as otherwise the memory of the previous block may have been reused.
+    TranslationCache::Link* link = nullptr;
+    u64 block_generation = 0;
 
     LOAD_NZCVT;
 DISPATCH: {
@@ -1639,17 +1977,30 @@ DISPATCH: {
     else
         cpu->Reg[15] &= 0xfffffffc;
 
-    // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    // Follow the link of the previous block if it is still valid, otherwise find the cached
+    // instruction cream, otherwise translate it...
+    auto& cache = cpu->instruction_cache;
+    if (link != nullptr && cache.IsLinked(*link, cpu->Reg[15])) {
+        ptr = link->entry;
     } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+        ptr = cache.Find(cpu->Reg[15]);
+        if (ptr == nullptr) {
+            // Translation reads the code through the memory and process of the running core
+            const auto context_lock = cpu->system.LockCoreContext(cpu->core_id);
+            if (cpu->NumInstrsToExecute != 1) {
+                if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            } else {
+                if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            }
+        }
+        if (link != nullptr && block_generation == cache.GetGeneration()) {
+            cache.SetLink(*link, cpu->Reg[15], ptr);
+        }
     }
+    link = nullptr;
+    block_generation = cache.GetGeneration();
 
 #ifndef ANDROID
     // Find breakpoint if one exists within the block
@@ -1659,7 +2010,7 @@ DISPATCH: {
     }
 #endif
 
-    inst_base = (arm_inst*)&trans_cache_buf[ptr];
+    inst_base = (arm_inst*)ptr;
     GOTO_NEXT_INST;
 }
 ADC_INST: {
@@ -1670,9 +2021,10 @@ ADC_INST: {
         if (inst_cream->Rn == 15)
             rn_val += 2 * cpu->GetInstructionSize();
 
-        bool carry;
-        bool overflow;
-        RD = AddWithCarry(rn_val, SHIFTER_OPERAND, cpu->CFlag, &carry, &overflow);
+        const u32 left = rn_val;
+        const u32 right = SHIFTER_OPERAND;
+        const u32 carry_in = cpu->CarryFlag();
+        RD = left + right + carry_in;
 
         if (inst_cream->S && (inst_cream->Rd == 15)) {
             if (cpu->CurrentModeHasSPSR()) {
@@ -1681,10 +2033,7 @@ ADC_INST: {
                 LOAD_NZCVT;
             }
         } else if (inst_cream->S) {
-            UPDATE_NFLAG(RD);
-            UPDATE_ZFLAG(RD);
-            cpu->CFlag = carry;
-            cpu->VFlag = overflow;
+            cpu->SetPendingFlags(left, right, carry_in);
         }
         if (inst_cream->Rd == 15) {
             INC_PC(sizeof(adc_inst));
@@ -1702,9 +2051,10 @@ ADD_INST: {
 
         u32 rn_val = CHECK_READ_REG15_WA(cpu, inst_cream->Rn);
 
-        bool carry;
-        bool overflow;
-        RD = AddWithCarry(rn_val, SHIFTER_OPERAND, 0, &carry, &overflow);
+        const u32 left = rn_val;
+        const u32 right = SHIFTER_OPERAND;
+        const u32 carry_in = 0;
+        RD = left + right + carry_in;
 
         if (inst_cream->S && (inst_cream->Rd == 15)) {
             if (cpu->CurrentModeHasSPSR()) {
@@ -1713,10 +2063,7 @@ ADD_INST: {
                 LOAD_NZCVT;
             }
         } else if (inst_cream->S) {
-            UPDATE_NFLAG(RD);
-            UPDATE_ZFLAG(RD);
-            cpu->CFlag = carry;
-            cpu->VFlag = overflow;
+            cpu->SetPendingFlags(left, right, carry_in);
         }
         if (inst_cream->Rd == 15) {
             INC_PC(sizeof(add_inst));
@@ -1769,10 +2116,14 @@ BBL_INST: {
         }
         SET_PC;
         INC_PC(sizeof(bbl_inst));
+        link = &inst_cream->link;
+        if (inst_cream->idle_loop)
+            goto IDLE_LOOP;
         goto DISPATCH;
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(bbl_inst));
+    link = &((bbl_inst*)inst_base->component)->link;
     goto DISPATCH;
 }
 BIC_INST: {
@@ -1908,14 +2259,7 @@ CMN_INST: {
         if (inst_cream->Rn == 15)
             rn_val += 2 * cpu->GetInstructionSize();
 
-        bool carry;
-        bool overflow;
-        u32 result = AddWithCarry(rn_val, SHIFTER_OPERAND, 0, &carry, &overflow);
-
-        UPDATE_NFLAG(result);
-        UPDATE_ZFLAG(result);
-        cpu->CFlag = carry;
-        cpu->VFlag = overflow;
+        cpu->SetPendingFlags(rn_val, SHIFTER_OPERAND, 0);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(cmn_inst));
@@ -1930,14 +2274,7 @@ CMP_INST: {
         if (inst_cream->Rn == 15)
             rn_val += 2 * cpu->GetInstructionSize();
 
-        bool carry;
-        bool overflow;
-        u32 result = AddWithCarry(rn_val, ~SHIFTER_OPERAND, 1, &carry, &overflow);
-
-        UPDATE_NFLAG(result);
-        UPDATE_ZFLAG(result);
-        cpu->CFlag = carry;
-        cpu->VFlag = overflow;
+        cpu->SetPendingFlags(rn_val, ~SHIFTER_OPERAND, 1);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(cmp_inst));
@@ -2236,9 +2573,7 @@ LDREX_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int read_addr = RN;
 
-        cpu->SetExclusiveMemoryAddress(read_addr);
-
-        RD = cpu->ReadMemory32(read_addr);
+        RD = cpu->ReadMemoryExclusive<u32>(read_addr);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -2250,9 +2585,7 @@ LDREXB_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int read_addr = RN;
 
-        cpu->SetExclusiveMemoryAddress(read_addr);
-
-        RD = cpu->ReadMemory8(read_addr);
+        RD = cpu->ReadMemoryExclusive<u8>(read_addr);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -2264,9 +2597,7 @@ LDREXH_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int read_addr = RN;
 
-        cpu->SetExclusiveMemoryAddress(read_addr);
-
-        RD = cpu->ReadMemory16(read_addr);
+        RD = cpu->ReadMemoryExclusive<u16>(read_addr);
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -2278,10 +2609,14 @@ LDREXD_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int read_addr = RN;
 
-        cpu->SetExclusiveMemoryAddress(read_addr);
-
-        RD = cpu->ReadMemory32(read_addr);
-        RD2 = cpu->ReadMemory32(read_addr + 4);
+        const u64 value = cpu->ReadMemoryExclusive<u64>(read_addr);
+        if (cpu->InBigEndianMode()) {
+            RD = static_cast<u32>(value >> 32);
+            RD2 = static_cast<u32>(value);
+        } else {
+            RD = static_cast<u32>(value);
+            RD2 = static_cast<u32>(value >> 32);
+        }
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -2833,9 +3168,10 @@ RSB_INST: {
         if (inst_cream->Rn == 15)
             rn_val += 2 * cpu->GetInstructionSize();
 
-        bool carry;
-        bool overflow;
-        RD = AddWithCarry(~rn_val, SHIFTER_OPERAND, 1, &carry, &overflow);
+        const u32 left = ~rn_val;
+        const u32 right = SHIFTER_OPERAND;
+        const u32 carry_in = 1;
+        RD = left + right + carry_in;
 
         if (inst_cream->S && (inst_cream->Rd == 15)) {
             if (cpu->CurrentModeHasSPSR()) {
@@ -2844,10 +3180,7 @@ RSB_INST: {
                 LOAD_NZCVT;
             }
         } else if (inst_cream->S) {
-            UPDATE_NFLAG(RD);
-            UPDATE_ZFLAG(RD);
-            cpu->CFlag = carry;
-            cpu->VFlag = overflow;
+            cpu->SetPendingFlags(left, right, carry_in);
         }
         if (inst_cream->Rd == 15) {
             INC_PC(sizeof(rsb_inst));
@@ -2867,9 +3200,10 @@ RSC_INST: {
         if (inst_cream->Rn == 15)
             rn_val += 2 * cpu->GetInstructionSize();
 
-        bool carry;
-        bool overflow;
-        RD = AddWithCarry(~rn_val, SHIFTER_OPERAND, cpu->CFlag, &carry, &overflow);
+        const u32 left = ~rn_val;
+        const u32 right = SHIFTER_OPERAND;
+        const u32 carry_in = cpu->CarryFlag();
+        RD = left + right + carry_in;
 
         if (inst_cream->S && (inst_cream->Rd == 15)) {
             if (cpu->CurrentModeHasSPSR()) {
@@ -2878,10 +3212,7 @@ RSC_INST: {
                 LOAD_NZCVT;
             }
         } else if (inst_cream->S) {
-            UPDATE_NFLAG(RD);
-            UPDATE_ZFLAG(RD);
-            cpu->CFlag = carry;
-            cpu->VFlag = overflow;
+            cpu->SetPendingFlags(left, right, carry_in);
         }
         if (inst_cream->Rd == 15) {
             INC_PC(sizeof(rsc_inst));
@@ -3009,9 +3340,10 @@ SBC_INST: {
         if (inst_cream->Rn == 15)
             rn_val += 2 * cpu->GetInstructionSize();
 
-        bool carry;
-        bool overflow;
-        RD = AddWithCarry(rn_val, ~SHIFTER_OPERAND, cpu->CFlag, &carry, &overflow);
+        const u32 left = rn_val;
+        const u32 right = ~SHIFTER_OPERAND;
+        const u32 carry_in = cpu->CarryFlag();
+        RD = left + right + carry_in;
 
         if (inst_cream->S && (inst_cream->Rd == 15)) {
             if (cpu->CurrentModeHasSPSR()) {
@@ -3020,10 +3352,7 @@ SBC_INST: {
                 LOAD_NZCVT;
             }
         } else if (inst_cream->S) {
-            UPDATE_NFLAG(RD);
-            UPDATE_ZFLAG(RD);
-            cpu->CFlag = carry;
-            cpu->VFlag = overflow;
+            cpu->SetPendingFlags(left, right, carry_in);
         }
         if (inst_cream->Rd == 15) {
             INC_PC(sizeof(sbc_inst));
@@ -3278,6 +3607,7 @@ SMLAL_INST: {
         RDLO = BITS(rst, 0, 31);
         RDHI = BITS(rst, 32, 63);
         if (inst_cream->S) {
+            cpu->ResolveFlags();
             cpu->NFlag = BIT(RDHI, 31);
             cpu->ZFlag = (RDHI == 0 && RDLO == 0);
         }
@@ -3449,6 +3779,7 @@ SMULL_INST: {
         RDLO = BITS(rst, 0, 31);
 
         if (inst_cream->S) {
+            cpu->ResolveFlags();
             cpu->NFlag = BIT(RDHI, 31);
             cpu->ZFlag = (RDHI == 0 && RDLO == 0);
         }
@@ -3715,14 +4046,8 @@ STREX_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int write_addr = cpu->Reg[inst_cream->Rn];
 
-        if (cpu->IsExclusiveMemoryAccess(write_addr)) {
-            cpu->UnsetExclusiveMemoryAddress();
-            cpu->WriteMemory32(write_addr, RM);
-            RD = 0;
-        } else {
-            // Failed to write due to mutex access
-            RD = 1;
-        }
+        // Fails when the monitor was cleared or memory changed since the exclusive load
+        RD = cpu->WriteMemoryExclusive<u32>(write_addr, RM) ? 0 : 1;
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -3734,14 +4059,8 @@ STREXB_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int write_addr = cpu->Reg[inst_cream->Rn];
 
-        if (cpu->IsExclusiveMemoryAccess(write_addr)) {
-            cpu->UnsetExclusiveMemoryAddress();
-            cpu->WriteMemory8(write_addr, cpu->Reg[inst_cream->Rm]);
-            RD = 0;
-        } else {
-            // Failed to write due to mutex access
-            RD = 1;
-        }
+        // Fails when the monitor was cleared or memory changed since the exclusive load
+        RD = cpu->WriteMemoryExclusive<u8>(write_addr, static_cast<u8>(RM)) ? 0 : 1;
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -3753,24 +4072,17 @@ STREXD_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int write_addr = cpu->Reg[inst_cream->Rn];
 
-        if (cpu->IsExclusiveMemoryAccess(write_addr)) {
-            cpu->UnsetExclusiveMemoryAddress();
-
-            const u32 rt = cpu->Reg[inst_cream->Rm + 0];
-            const u32 rt2 = cpu->Reg[inst_cream->Rm + 1];
-            u64 value;
+        const u32 rt = cpu->Reg[inst_cream->Rm + 0];
+        const u32 rt2 = cpu->Reg[inst_cream->Rm + 1];
+        u64 value;
 
-            if (cpu->InBigEndianMode())
-                value = (((u64)rt << 32) | rt2);
-            else
-                value = (((u64)rt2 << 32) | rt);
+        if (cpu->InBigEndianMode())
+            value = (((u64)rt << 32) | rt2);
+        else
+            value = (((u64)rt2 << 32) | rt);
 
-            cpu->WriteMemory64(write_addr, value);
-            RD = 0;
-        } else {
-            // Failed to write due to mutex access
-            RD = 1;
-        }
+        // Fails when the monitor was cleared or memory changed since the exclusive load
+        RD = cpu->WriteMemoryExclusive<u64>(write_addr, value) ? 0 : 1;
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -3782,14 +4094,8 @@ STREXH_INST: {
         generic_arm_inst* inst_cream = (generic_arm_inst*)inst_base->component;
         unsigned int write_addr = cpu->Reg[inst_cream->Rn];
 
-        if (cpu->IsExclusiveMemoryAccess(write_addr)) {
-            cpu->UnsetExclusiveMemoryAddress();
-            cpu->WriteMemory16(write_addr, RM);
-            RD = 0;
-        } else {
-            // Failed to write due to mutex access
-            RD = 1;
-        }
+        // Fails when the monitor was cleared or memory changed since the exclusive load
+        RD = cpu->WriteMemoryExclusive<u16>(write_addr, static_cast<u16>(RM)) ? 0 : 1;
     }
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(generic_arm_inst));
@@ -3836,9 +4142,10 @@ SUB_INST: {
 
         u32 rn_val = CHECK_READ_REG15_WA(cpu, inst_cream->Rn);
 
-        bool carry;
-        bool overflow;
-        RD = AddWithCarry(rn_val, ~SHIFTER_OPERAND, 1, &carry, &overflow);
+        const u32 left = rn_val;
+        const u32 right = ~SHIFTER_OPERAND;
+        const u32 carry_in = 1;
+        RD = left + right + carry_in;
 
         if (inst_cream->S && (inst_cream->Rd == 15)) {
             if (cpu->CurrentModeHasSPSR()) {
@@ -3847,10 +4154,7 @@ SUB_INST: {
                 LOAD_NZCVT;
             }
         } else if (inst_cream->S) {
-            UPDATE_NFLAG(RD);
-            UPDATE_ZFLAG(RD);
-            cpu->CFlag = carry;
-            cpu->VFlag = overflow;
+            cpu->SetPendingFlags(left, right, carry_in);
         }
         if (inst_cream->Rd == 15) {
             INC_PC(sizeof(sub_inst));
@@ -3865,6 +4169,7 @@ SUB_INST: {
 SWI_INST: {
     if (inst_base->cond == ConditionCode::AL || CondPassed(cpu, inst_base->cond)) {
         swi_inst* const inst_cream = (swi_inst*)inst_base->component;
+        const auto context_lock = cpu->system.LockCoreContext(cpu->core_id);
         cpu->system.GetRunningCore().GetTimer().AddTicks(num_instrs);
         cpu->NumInstrsToExecute =
             num_instrs >= cpu->NumInstrsToExecute ? 0 : cpu->NumInstrsToExecute - num_instrs;
@@ -4291,6 +4596,7 @@ UMLAL_INST: {
         RDHI = BITS(rst, 32, 63);
 
         if (inst_cream->S) {
+            cpu->ResolveFlags();
             cpu->NFlag = BIT(RDHI, 31);
             cpu->ZFlag = (RDHI == 0 && RDLO == 0);
         }
@@ -4310,6 +4616,7 @@ UMULL_INST: {
         RDLO = BITS(rst, 0, 31);
 
         if (inst_cream->S) {
+            cpu->ResolveFlags();
             cpu->NFlag = BIT(RDHI, 31);
             cpu->ZFlag = (RDHI == 0 && RDLO == 0);
         }
@@ -4323,17 +4630,23 @@ B_2_THUMB: {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
     INC_PC(sizeof(b_2_thumb));
+    link = &inst_cream->link;
+    if (inst_cream->idle_loop)
+        goto IDLE_LOOP;
     goto DISPATCH;
 }
 B_COND_THUMB: {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-    if (CondPassed(cpu, inst_cream->cond))
+    INC_PC(sizeof(b_cond_thumb));
+    link = &inst_cream->link;
+    if (CondPassed(cpu, inst_cream->cond)) {
         cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
+        if (inst_cream->idle_loop)
+            goto IDLE_LOOP;
+    } else {
         cpu->Reg[15] += 2;
-
-    INC_PC(sizeof(b_cond_thumb));
+    }
     goto DISPATCH;
 }
 BL_1_THUMB: {
@@ -4350,6 +4663,7 @@ BL_2_THUMB: {
     cpu->Reg[15] = (cpu->Reg[14] + inst_cream->imm);
     cpu->Reg[14] = tmp;
     INC_PC(sizeof(bl_2_thumb));
+    link = &inst_cream->link;
     goto DISPATCH;
 }
 BLX_1_THUMB: {
@@ -4578,6 +4892,98 @@ YIELD_INST: {
 #include "core/arm/skyeye_common/vfp/vfpinstr.cpp"
 #undef VFP_INTERPRETER_IMPL
 
+// Superinstructions: a compare followed by a conditional branch. The pair counts as two
+// instructions, so that the emulated timing does not depend on the fusion. If the instruction
+// budget does not cover both, the compare executes on its own and the branch is left for the
+// next run.
+CMP_BRANCH_INST: {
+    if (num_instrs + 2 > cpu->NumInstrsToExecute)
+        goto CMP_INST;
+    num_instrs += 2;
+
+    cmp_inst* const inst_cream = (cmp_inst*)inst_base->component;
+    u32 rn_val = RN;
+    if (inst_cream->Rn == 15)
+        rn_val += 2 * cpu->GetInstructionSize();
+
+    cpu->SetPendingFlags(rn_val, ~SHIFTER_OPERAND, 1);
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    INC_PC(sizeof(cmp_inst));
+    goto FUSED_COND_BRANCH;
+}
+TST_BRANCH_INST: {
+    if (num_instrs + 2 > cpu->NumInstrsToExecute)
+        goto TST_INST;
+    num_instrs += 2;
+
+    tst_inst* const inst_cream = (tst_inst*)inst_base->component;
+    u32 lop = RN;
+    u32 rop = SHIFTER_OPERAND;
+    if (inst_cream->Rn == 15)
+        lop += cpu->GetInstructionSize() * 2;
+
+    u32 result = lop & rop;
+
+    UPDATE_NFLAG(result);
+    UPDATE_ZFLAG(result);
+    UPDATE_CFLAG_WITH_SC;
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    INC_PC(sizeof(tst_inst));
+    goto FUSED_COND_BRANCH;
+}
+CMN_BRANCH_INST: {
+    if (num_instrs + 2 > cpu->NumInstrsToExecute)
+        goto CMN_INST;
+    num_instrs += 2;
+
+    cmn_inst* const inst_cream = (cmn_inst*)inst_base->component;
+    u32 rn_val = RN;
+    if (inst_cream->Rn == 15)
+        rn_val += 2 * cpu->GetInstructionSize();
+
+    cpu->SetPendingFlags(rn_val, SHIFTER_OPERAND, 0);
+
+    cpu->Reg[15] += cpu->GetInstructionSize();
+    INC_PC(sizeof(cmn_inst));
+    goto FUSED_COND_BRANCH;
+}
+FUSED_COND_BRANCH: {
+    inst_base = (arm_inst*)ptr;
+    if (cpu->TFlag) {
+        b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
+        INC_PC(sizeof(b_cond_thumb));
+        link = &inst_cream->link;
+        if (CondPassed(cpu, inst_cream->cond)) {
+            cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
+            if (inst_cream->idle_loop)
+                goto IDLE_LOOP;
+        } else {
+            cpu->Reg[15] += 2;
+        }
+    } else {
+        bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
+        INC_PC(sizeof(bbl_inst));
+        link = &inst_cream->link;
+        if (CondPassed(cpu, inst_base->cond)) {
+            SET_PC;
+            if (inst_cream->idle_loop)
+                goto IDLE_LOOP;
+        } else {
+            cpu->Reg[15] += cpu->GetInstructionSize();
+        }
+    }
+    goto DISPATCH;
+}
+
+// The block just executed only polls memory, which nothing changes before the next event. The
+// core stops here and the rest of its slice is skipped.
+IDLE_LOOP: {
+    cpu->reached_idle_loop = true;
+    goto END;
+}
+
 END: {
     SAVE_NZCVT;
     cpu->NumInstrsToExecute = 0;
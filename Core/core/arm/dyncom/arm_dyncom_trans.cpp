@@ -1,4 +1,5 @@
 #include <cstdlib>
+#include <memory>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "core/arm/dyncom/arm_dyncom_trans.h"
@@ -6,14 +7,30 @@
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
 
-char trans_cache_buf[TRANS_CACHE_SIZE];
-size_t trans_cache_buf_top = 0;
+namespace {
+// Blocks are translated into a staging area of the translating thread, and copied into the
+// translation cache of the core once their size is known.
+struct TransStagingBuffer {
+    std::unique_ptr<char[]> data = std::make_unique<char[]>(TRANS_STAGING_SIZE);
+    std::size_t top = 0;
+};
+thread_local TransStagingBuffer trans_staging_buf;
+} // namespace
+
+char* BeginTransBlock() {
+    trans_staging_buf.top = 0;
+    return trans_staging_buf.data.get();
+}
+
+std::size_t GetTransBlockSize() {
+    return trans_staging_buf.top;
+}
 
 static void* AllocBuffer(std::size_t size) {
-    std::size_t start = trans_cache_buf_top;
-    trans_cache_buf_top += size;
-    ASSERT_MSG(trans_cache_buf_top <= TRANS_CACHE_SIZE, "Translation cache is full!");
-    return static_cast<void*>(&trans_cache_buf[start]);
+    std::size_t start = trans_staging_buf.top;
+    trans_staging_buf.top += size;
+    ASSERT_MSG(trans_staging_buf.top <= TRANS_STAGING_SIZE, "Translation staging buffer is full!");
+    return static_cast<void*>(&trans_staging_buf.data[start]);
 }
 
 #define glue(x, y) x##y
@@ -99,6 +116,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bbl)(unsigned int inst, int index) {
 
     inst_cream->L = BIT(inst, 24);
     inst_cream->signed_immed_24 = BIT(inst, 23) ? NEGBRANCH : POSBRANCH;
+    inst_cream->link = {};
+    inst_cream->idle_loop = false;
 
     return inst_base;
 }
@@ -1646,6 +1665,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_2_thumb)(unsigned int tinst, int ind
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
 
     inst_cream->imm = ((tinst & 0x3FF) << 1) | ((tinst & (1 << 10)) ? 0xFFFFF800 : 0);
+    inst_cream->link = {};
+    inst_cream->idle_loop = false;
 
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
@@ -1659,6 +1680,8 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(b_cond_thumb)(unsigned int tinst, int
 
     inst_cream->imm = (((tinst & 0x7F) << 1) | ((tinst & (1 << 7)) ? 0xFFFFFF00 : 0));
     inst_cream->cond = ((tinst >> 8) & 0xf);
+    inst_cream->link = {};
+    inst_cream->idle_loop = false;
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
 
@@ -1680,6 +1703,7 @@ static ARM_INST_PTR INTERPRETER_TRANSLATE(bl_2_thumb)(unsigned int tinst, int in
     bl_2_thumb* inst_cream = (bl_2_thumb*)inst_base->component;
 
     inst_cream->imm = (tinst & 0x07FF) << 1;
+    inst_cream->link = {};
 
     inst_base->idx = index;
     inst_base->br = TransExtData::DIRECT_BRANCH;
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include "common/logging/log.h"
+#include "common/settings.h"
 #include "common/swap.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
@@ -12,7 +13,9 @@
 
 ARMul_State::ARMul_State(Core::System& system_, Memory::MemorySystem& memory_,
                          PrivilegeMode initial_mode)
-    : system{system_}, memory{memory_} {
+    : system{system_}, memory{memory_},
+      instruction_cache{static_cast<std::size_t>(Settings::values.dyncom_cache_size.GetValue()) *
+                        1024 * 1024} {
     Reset();
     ChangePrivilegeMode(initial_mode);
 }
@@ -183,9 +186,9 @@ void ARMul_State::ResetMPCoreCP15Registers() {
     CP15[CP15_TLB_DEBUG_CONTROL] = 0x00000000;
 }
 #ifdef ANDROID
-static void CheckMemoryBreakpoint(u32 address, GDBStub::BreakpointType type) {}
+void ARMul_State::CheckMemoryBreakpoint(u32 address, GDBStub::BreakpointType type) const {}
 #else
-static void CheckMemoryBreakpoint(u32 address, GDBStub::BreakpointType type) {
+void ARMul_State::CheckMemoryBreakpoint(u32 address, GDBStub::BreakpointType type) const {
     if (GDBStub::IsServerEnabled() && GDBStub::CheckBreakpoint(address, type)) {
         LOG_DEBUG(Debug, "Found memory breakpoint @ {:08x}", address);
         GDBStub::Break(true);
@@ -193,77 +196,43 @@ static void CheckMemoryBreakpoint(u32 address, GDBStub::BreakpointType type) {
 }
 #endif
 
-u8 ARMul_State::ReadMemory8(u32 address) const {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
-
-    return memory.Read8(address);
-}
-
-u16 ARMul_State::ReadMemory16(u32 address) const {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
-
-    u16 data = memory.Read16(address);
-
-    if (InBigEndianMode())
-        data = Common::swap16(data);
-
-    return data;
-}
-
-u32 ARMul_State::ReadMemory32(u32 address) const {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
-
-    u32 data = memory.Read32(address);
-
-    if (InBigEndianMode())
-        data = Common::swap32(data);
-
-    return data;
-}
-
-u64 ARMul_State::ReadMemory64(u32 address) const {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
-
-    u64 data = memory.Read64(address);
-
-    if (InBigEndianMode())
-        data = Common::swap64(data);
-
-    return data;
-}
-
-void ARMul_State::WriteMemory8(u32 address, u8 data) {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Write);
-
-    memory.Write8(address, data);
-}
-
-void ARMul_State::WriteMemory16(u32 address, u16 data) {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Write);
-
-    if (InBigEndianMode())
-        data = Common::swap16(data);
-
-    memory.Write16(address, data);
+template <typename T>
+T ARMul_State::ReadMemorySlow(u32 address) const {
+    // MMIO handlers act on the state of the running core
+    const auto context_lock = system.LockCoreContext(core_id);
+    if constexpr (sizeof(T) == 1) {
+        return memory.Read8(address);
+    } else if constexpr (sizeof(T) == 2) {
+        return memory.Read16(address);
+    } else if constexpr (sizeof(T) == 4) {
+        return memory.Read32(address);
+    } else {
+        return memory.Read64(address);
+    }
 }
 
-void ARMul_State::WriteMemory32(u32 address, u32 data) {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Write);
-
-    if (InBigEndianMode())
-        data = Common::swap32(data);
-
-    memory.Write32(address, data);
+template <typename T>
+void ARMul_State::WriteMemorySlow(u32 address, T data) {
+    const auto context_lock = system.LockCoreContext(core_id);
+    if constexpr (sizeof(T) == 1) {
+        memory.Write8(address, data);
+    } else if constexpr (sizeof(T) == 2) {
+        memory.Write16(address, data);
+    } else if constexpr (sizeof(T) == 4) {
+        memory.Write32(address, data);
+    } else {
+        memory.Write64(address, data);
+    }
 }
 
-void ARMul_State::WriteMemory64(u32 address, u64 data) {
-    CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Write);
-
-    if (InBigEndianMode())
-        data = Common::swap64(data);
-
-    memory.Write64(address, data);
-}
+template u8 ARMul_State::ReadMemorySlow<u8>(u32 address) const;
+template u16 ARMul_State::ReadMemorySlow<u16>(u32 address) const;
+template u32 ARMul_State::ReadMemorySlow<u32>(u32 address) const;
+template u64 ARMul_State::ReadMemorySlow<u64>(u32 address) const;
+template void ARMul_State::WriteMemorySlow<u8>(u32 address, u8 data);
+template void ARMul_State::WriteMemorySlow<u16>(u32 address, u16 data);
+template void ARMul_State::WriteMemorySlow<u32>(u32 address, u32 data);
+template void ARMul_State::WriteMemorySlow<u64>(u32 address, u64 data);
 
 // Reads from the CP15 registers. Used with implementation of the MRC instruction.
 // Note that since the 3DS does not have the hypervisor extensions, these registers
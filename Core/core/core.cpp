@@ -10,7 +10,9 @@
 #include "audio_core/lle/lle.h"
 #include "common/arch.h"
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
 #include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/hle/service/cam/cam.h"
@@ -44,6 +46,7 @@
 #include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
 #include "core/movie.h"
+#include "core/rewind_buffer.h"
 #ifdef ENABLE_SCRIPTING
 #include "core/rpc/server.h"
 #endif
@@ -71,7 +74,9 @@ Core::Timing& Global() {
     return System::GetInstance().CoreTiming();
 }
 
-System::System() : movie{*this}, cheat_engine{*this} {}
+System::System()
+    : movie{*this}, rewind_buffer{std::make_unique<Core::RewindBuffer>(*this)},
+      cheat_engine{*this} {}
 
 System::~System() = default;
 
@@ -224,46 +229,62 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             current_core_to_execute->GetTimer().Idle();
             PrepareReschedule();
         } else {
+            perf_stats->BeginCPUProcessing();
             if (tight_loop) {
                 current_core_to_execute->Run();
             } else {
                 current_core_to_execute->Step();
             }
+            perf_stats->EndCPUProcessing();
         }
     } else {
         // Now all cores are at the same global time. So we will run them one after the other
         // with a max slice that is the minimum of all max slices of all cores
         // TODO: Make special check for idle since we can easily revert the time of idle cores
-        s64 max_slice = Timing::MAX_SLICE_LENGTH;
+        s64 max_slice = Timing::LONG_SLICE_LENGTH;
+        bool wakeups_pending = false;
         for (const auto& cpu_core : cpu_cores) {
             running_core = cpu_core.get();
             kernel->SetRunningCPU(running_core);
             cpu_core->GetTimer().Advance();
             cpu_core->PrepareReschedule();
-            kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
-            max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
+            auto& thread_manager = kernel->GetThreadManager(cpu_core->GetID());
+            thread_manager.Reschedule();
+            wakeups_pending |= thread_manager.HasPendingWakeups();
+            max_slice = std::min(max_slice,
+                                 cpu_core->GetTimer().GetMaxSliceLength(Timing::LONG_SLICE_LENGTH));
         }
-        for (auto& cpu_core : cpu_cores) {
-            cpu_core->GetTimer().SetNextSlice(max_slice);
-            auto start_ticks = cpu_core->GetTimer().GetTicks();
-            LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
-                      cpu_core->GetTimer().GetDowncount());
-            running_core = cpu_core.get();
-            kernel->SetRunningCPU(running_core);
-            // If we don't have a currently active thread then don't execute instructions,
-            // instead advance to the next event and try to yield to the next thread
-            if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
-                LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
-                cpu_core->GetTimer().Idle();
-                PrepareReschedule();
-            } else {
-                if (tight_loop) {
-                    cpu_core->Run();
+        // Without timeouts to wait for, the cores need to meet less often.
+        if (wakeups_pending) {
+            max_slice = std::min<s64>(max_slice, Timing::MAX_SLICE_LENGTH);
+        }
+        if (core_workers && !GDBStub::IsServerEnabled()) {
+            RunCoresInParallel(max_slice, tight_loop);
+        } else {
+            for (auto& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                auto start_ticks = cpu_core->GetTimer().GetTicks();
+                LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                          cpu_core->GetTimer().GetDowncount());
+                running_core = cpu_core.get();
+                kernel->SetRunningCPU(running_core);
+                // If we don't have a currently active thread then don't execute instructions,
+                // instead advance to the next event and try to yield to the next thread
+                if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    PrepareReschedule();
                 } else {
-                    cpu_core->Step();
+                    perf_stats->BeginCPUProcessing();
+                    if (tight_loop) {
+                        cpu_core->Run();
+                    } else {
+                        cpu_core->Step();
+                    }
+                    perf_stats->EndCPUProcessing();
                 }
+                max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
             }
-            max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
         }
     }
 
@@ -276,6 +297,44 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     return status;
 }
 
+System::ResultStatus System::RunFrame() {
+    if (!IsPoweredOn()) {
+        return ResultStatus::ErrorNotInitialized;
+    }
+
+    // Bound the amount of emulated time, so that a guest with VBlank stalled (e.g. while the
+    // GPU is being reset) still returns control to the frontend.
+    constexpr u64 max_frame_ticks = VideoCore::FRAME_TICKS * 2;
+
+    // The frontend runs between the frames, so the time until the next call counts as idle.
+    perf_stats->BeginRunFrame();
+    SCOPE_EXIT({
+        if (perf_stats) {
+            perf_stats->EndRunFrame();
+        }
+    });
+
+    const u64 start_vblank = gpu->GetVBlankCount();
+    const u64 start_ticks = timing->GetGlobalTicks();
+    while (true) {
+        const ResultStatus result = RunLoop();
+        if (result != ResultStatus::Success || !IsPoweredOn()) {
+            return result;
+        }
+        if (gpu->GetVBlankCount() != start_vblank) {
+            break;
+        }
+        // A savestate load moves the global time backwards, which also ends the frame here.
+        if (timing->GetGlobalTicks() - start_ticks >= max_frame_ticks) {
+            break;
+        }
+        if (GDBStub::IsServerEnabled() && GDBStub::GetCpuHaltFlag()) {
+            break;
+        }
+    }
+    return ResultStatus::Success;
+}
+
 bool System::SendSignal(System::Signal signal, u32 param) {
     std::scoped_lock lock{signal_mutex};
     if (current_signal != signal && current_signal != Signal::None) {
@@ -417,6 +476,61 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     return status;
 }
 
+void System::RunCoresInParallel(s64 max_slice, bool tight_loop) {
+    std::vector<ARM_Interface*> active_cores;
+    for (auto& cpu_core : cpu_cores) {
+        cpu_core->GetTimer().SetNextSlice(max_slice);
+        running_core = cpu_core.get();
+        kernel->SetRunningCPU(running_core);
+        if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+            LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+            cpu_core->GetTimer().Idle();
+            PrepareReschedule();
+        } else {
+            active_cores.push_back(cpu_core.get());
+        }
+    }
+    if (active_cores.empty()) {
+        return;
+    }
+
+    const auto run = [tight_loop](ARM_Interface* cpu_core) {
+        LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                  cpu_core->GetTimer().GetDowncount());
+        if (tight_loop) {
+            cpu_core->Run();
+        } else {
+            cpu_core->Step();
+        }
+    };
+
+    // The cores only meet at the slice boundary. In between, each core takes the context lock
+    // whenever it leaves its own state, see LockCoreContext.
+    perf_stats->BeginCPUProcessing();
+    cores_running_in_parallel = true;
+    for (std::size_t i = 1; i < active_cores.size(); i++) {
+        core_workers->QueueWork([&run, cpu_core = active_cores[i]] { run(cpu_core); });
+    }
+    run(active_cores[0]);
+    core_workers->WaitForRequests();
+    cores_running_in_parallel = false;
+    perf_stats->EndCPUProcessing();
+}
+
+std::unique_lock<std::recursive_mutex> System::LockCoreContext(u32 core_id) {
+    if (!cores_running_in_parallel) {
+        return {};
+    }
+
+    std::unique_lock lock{core_context_mutex};
+    ARM_Interface* const core = cpu_cores[core_id].get();
+    if (running_core != core) {
+        running_core = core;
+        kernel->SetRunningCPU(running_core);
+    }
+    return lock;
+}
+
 void System::PrepareReschedule() {
     running_core->PrepareReschedule();
     reschedule_pending = true;
@@ -453,7 +567,9 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
                                   const Kernel::New3dsHwCapabilities& n3ds_hw_caps, u32 num_cores) {
     LOG_DEBUG(HW_Memory, "initialized OK");
 
-    memory = std::make_unique<Memory::MemorySystem>(*this);
+    memory = std::make_unique<Memory::MemorySystem>(
+        *this, kept_ram ? std::move(*kept_ram) : Memory::RamStorage{});
+    kept_ram.reset();
 
     timing = std::make_unique<Timing>(num_cores, Settings::values.cpu_clock_percentage.GetValue(),
                                       movie.GetOverrideBaseTicks());
@@ -485,6 +601,14 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     }
     running_core = cpu_cores[0].get();
 
+    if (Settings::values.parallel_cpu_cores && num_cores > 1) {
+        if (dynamic_cast<ARM_DynCom*>(running_core) != nullptr) {
+            core_workers = std::make_unique<Common::ThreadWorker>(num_cores - 1, "CPU core");
+        } else {
+            LOG_WARNING(Core, "Parallel CPU cores are only supported by the interpreter");
+        }
+    }
+
     kernel->SetCPUs(cpu_cores);
     kernel->SetRunningCPU(cpu_cores[0].get());
 
@@ -617,6 +741,10 @@ const Core::Movie& System::Movie() const {
     return movie;
 }
 
+Core::RewindBuffer& System::RewindBuffer() {
+    return *rewind_buffer;
+}
+
 void System::RegisterMiiSelector(std::shared_ptr<Frontend::MiiSelector> mii_selector) {
     registered_mii_selector = std::move(mii_selector);
 }
@@ -640,6 +768,7 @@ void System::Shutdown(bool is_deserializing) {
         GDBStub::Shutdown();
         perf_stats.reset();
         app_loader.reset();
+        rewind_buffer->Clear();
     }
     custom_tex_manager.reset();
 #ifdef ENABLE_SCRIPTING
@@ -649,6 +778,7 @@ void System::Shutdown(bool is_deserializing) {
     service_manager.reset();
     dsp_core.reset();
     kernel.reset();
+    core_workers.reset();
     cpu_cores.clear();
     exclusive_monitor.reset();
     timing.reset();
@@ -662,6 +792,9 @@ void System::Shutdown(bool is_deserializing) {
         room_member->SendGameInfo(game_info);
     }
 
+    if (is_deserializing && ram_state_handler && memory) {
+        kept_ram = std::make_unique<Memory::RamStorage>(memory->ReleaseRam());
+    }
     memory.reset();
 
     if (self_delete_pending)
@@ -741,6 +874,8 @@ void System::ApplySettings() {
         Service::MIC::ReloadMic(*this);
     }
 
+    rewind_buffer->ApplyBudget();
+
     auto plg_ldr = Service::PLGLDR::GetService(*this);
     if (plg_ldr) {
         plg_ldr->SetEnabled(Settings::values.plugin_loader_enabled.GetValue());
@@ -21,6 +21,177 @@ bool Timing::Event::operator<(const Timing::Event& right) const {
     return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
 }
 
+void Timing::EventQueue::Push(const Event& event) {
+    u32 slot;
+    if (free_slots.empty()) {
+        slot = static_cast<u32>(slots.size());
+        slots.emplace_back();
+    } else {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+
+    Slot& new_slot = slots[slot];
+    new_slot.event = event;
+    new_slot.prev_same_key = INVALID_SLOT;
+    new_slot.next_same_key = INVALID_SLOT;
+    const auto [itr, inserted] = latest_by_key.try_emplace(Key{event.type, event.user_data}, slot);
+    if (!inserted) {
+        new_slot.next_same_key = itr->second;
+        slots[itr->second].prev_same_key = slot;
+        itr->second = slot;
+    }
+
+    heap.emplace_back();
+    Place(heap.size() - 1, HeapEntry{event.time, event.fifo_order, slot});
+    SiftUp(heap.size() - 1);
+    event.type->num_pending++;
+}
+
+Timing::Event Timing::EventQueue::Pop() {
+    const u32 slot = heap.front().slot;
+    const Event event = slots[slot].event;
+    UnlinkFromKey(slot);
+    RemoveFromHeap(slot);
+    return event;
+}
+
+void Timing::EventQueue::Remove(const TimingEventType* type, std::uintptr_t user_data) {
+    const auto itr = latest_by_key.find(Key{type, user_data});
+    if (itr == latest_by_key.end()) {
+        return;
+    }
+    for (u32 slot = itr->second; slot != INVALID_SLOT;) {
+        const u32 next = slots[slot].next_same_key;
+        RemoveFromHeap(slot);
+        slot = next;
+    }
+    latest_by_key.erase(itr);
+}
+
+void Timing::EventQueue::RemoveType(const TimingEventType* type) {
+    std::vector<u32> removed;
+    for (const HeapEntry& entry : heap) {
+        if (slots[entry.slot].event.type == type) {
+            removed.push_back(entry.slot);
+        }
+    }
+    for (const u32 slot : removed) {
+        UnlinkFromKey(slot);
+        RemoveFromHeap(slot);
+    }
+}
+
+std::vector<Timing::Event> Timing::EventQueue::GetEvents() const {
+    std::vector<Event> events;
+    events.reserve(heap.size());
+    for (const HeapEntry& entry : heap) {
+        events.push_back(slots[entry.slot].event);
+    }
+    return events;
+}
+
+void Timing::EventQueue::SetEvents(const std::vector<Event>& events) {
+    for (const HeapEntry& entry : heap) {
+        slots[entry.slot].event.type->num_pending--;
+    }
+    heap.clear();
+    slots.clear();
+    free_slots.clear();
+    latest_by_key.clear();
+    for (const Event& event : events) {
+        Push(event);
+    }
+}
+
+s64 Timing::EventQueue::GetLatestTimeUntil(s64 limit) const {
+    return GetLatestTimeUntil(0, limit);
+}
+
+s64 Timing::EventQueue::GetLatestTimeUntil(std::size_t index, s64 limit) const {
+    // Children are never due before their parent, so whole subtrees past the limit are skipped.
+    if (index >= heap.size() || heap[index].time > limit) {
+        return std::numeric_limits<s64>::min();
+    }
+    return std::max({heap[index].time, GetLatestTimeUntil(index * 2 + 1, limit),
+                     GetLatestTimeUntil(index * 2 + 2, limit)});
+}
+
+void Timing::EventQueue::Place(std::size_t index, const HeapEntry& entry) {
+    heap[index] = entry;
+    slots[entry.slot].heap_index = static_cast<u32>(index);
+}
+
+void Timing::EventQueue::SiftUp(std::size_t index) {
+    const HeapEntry entry = heap[index];
+    while (index > 0) {
+        const std::size_t parent = (index - 1) / 2;
+        if (!(entry < heap[parent])) {
+            break;
+        }
+        Place(index, heap[parent]);
+        index = parent;
+    }
+    Place(index, entry);
+}
+
+void Timing::EventQueue::SiftDown(std::size_t index) {
+    const HeapEntry entry = heap[index];
+    const std::size_t size = heap.size();
+    while (true) {
+        std::size_t child = index * 2 + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && heap[child + 1] < heap[child]) {
+            child++;
+        }
+        if (!(heap[child] < entry)) {
+            break;
+        }
+        Place(index, heap[child]);
+        index = child;
+    }
+    Place(index, entry);
+}
+
+void Timing::EventQueue::RemoveFromHeap(u32 slot) {
+    slots[slot].event.type->num_pending--;
+    const std::size_t index = slots[slot].heap_index;
+    const HeapEntry last = heap.back();
+    heap.pop_back();
+    free_slots.push_back(slot);
+    if (index == heap.size()) {
+        return;
+    }
+
+    Place(index, last);
+    if (index > 0 && last < heap[(index - 1) / 2]) {
+        SiftUp(index);
+    } else {
+        SiftDown(index);
+    }
+}
+
+void Timing::EventQueue::UnlinkFromKey(u32 slot) {
+    const Slot& removed = slots[slot];
+    if (removed.next_same_key != INVALID_SLOT) {
+        slots[removed.next_same_key].prev_same_key = removed.prev_same_key;
+    }
+    if (removed.prev_same_key != INVALID_SLOT) {
+        slots[removed.prev_same_key].next_same_key = removed.next_same_key;
+        return;
+    }
+
+    // The slot is the latest event of its key
+    const auto itr = latest_by_key.find(Key{removed.event.type, removed.event.user_data});
+    if (removed.next_same_key == INVALID_SLOT) {
+        latest_by_key.erase(itr);
+    } else {
+        itr->second = removed.next_same_key;
+    }
+}
+
 Timing::Timing(std::size_t num_cores, u32 cpu_clock_percentage, s64 override_base_ticks) {
     // Generate non-zero base tick count to simulate time the system ran before launching the game.
     // This accounts for games that rely on the system tick to seed randomness.
@@ -32,6 +203,12 @@ Timing::Timing(std::size_t num_cores, u32 cpu_clock_percentage, s64 override_bas
     }
     UpdateClockSpeed(cpu_clock_percentage);
     current_timer = timers[0].get();
+
+    const s64 coalescing_window =
+        usToCycles(static_cast<s64>(Settings::values.event_coalescing_window.GetValue()));
+    for (auto& timer : timers) {
+        timer->coalescing_window = coalescing_window;
+    }
 }
 
 s64 Timing::GenerateBaseTicks() {
@@ -83,8 +260,8 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
         // of MAX_SLICE_LENGTH * 2 cycles into the future.
         cycles_into_future = std::max(static_cast<s64>(MAX_SLICE_LENGTH * 2), cycles_into_future);
 
-        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                   user_data, event_type});
+        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future),
+                                   timer->ts_pushed++, user_data, event_type});
     } else {
         s64 timeout = timer->GetTicks() + cycles_into_future;
         if (current_timer == timer) {
@@ -92,12 +269,10 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
             if (!timer->is_timer_sane)
                 timer->ForceExceptionCheck(cycles_into_future);
 
-            timer->event_queue.emplace_back(
-                Event{timeout, timer->event_fifo_id++, user_data, event_type});
-            std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+            timer->event_queue.Push(Event{timeout, timer->event_fifo_id++, user_data, event_type});
         } else {
-            timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                       user_data, event_type});
+            timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future),
+                                       timer->ts_pushed++, user_data, event_type});
         }
     }
 }
@@ -106,35 +281,20 @@ void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t u
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.user_data == user_data; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+    for (auto& timer : timers) {
+        timer->event_queue.Remove(event_type, user_data);
+        timer->CancelQueuedEvents(event_type, user_data, false);
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+    for (auto& timer : timers) {
+        timer->event_queue.RemoveType(event_type);
+        timer->CancelQueuedEvents(event_type, 0, true);
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::SetCurrentTimer(std::size_t core_id) {
@@ -161,6 +321,15 @@ std::shared_ptr<Timing::Timer> Timing::GetTimer(std::size_t cpu_id) {
     return timers[cpu_id];
 }
 
+std::vector<Timing::EventStats> Timing::GetEventStats() const {
+    std::vector<EventStats> stats;
+    stats.reserve(event_types.size());
+    for (const auto& [name, event_type] : event_types) {
+        stats.push_back({name, event_type.num_fired, event_type.host_time});
+    }
+    return stats;
+}
+
 Timing::Timer::Timer(s64 base_ticks) : executed_ticks(base_ticks) {}
 
 Timing::Timer::~Timer() {
@@ -185,7 +354,8 @@ u64 Timing::Timer::GetIdleTicks() const {
 
 void Timing::Timer::ForceExceptionCheck(s64 cycles) {
     cycles = std::max<s64>(0, cycles);
-    if (downcount > cycles) {
+    // An event due shortly before the end of the slice is handled at the end of the slice.
+    if (downcount - cycles > coalescing_window) {
         slice_length -= downcount - cycles;
         downcount = cycles;
     }
@@ -193,19 +363,47 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 
 void Timing::Timer::MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
+        ts_moved++;
+        const bool cancelled =
+            std::any_of(ts_cancellations.begin(), ts_cancellations.end(), [&](const auto& c) {
+                return c.type == ev.type && (c.any_user_data || c.user_data == ev.user_data) &&
+                       ev.fifo_order < c.pushed_before;
+            });
+        if (cancelled) {
+            continue;
+        }
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.Push(ev);
+    }
+    // Once every pushed event has been moved, no cancelled event can be left in the queue.
+    if (!ts_cancellations.empty() && ts_moved == ts_pushed) {
+        ts_cancellations.clear();
+    }
+}
+
+void Timing::Timer::CancelQueuedEvents(const TimingEventType* type, std::uintptr_t user_data,
+                                       bool any_user_data) {
+    const u64 pushed = ts_pushed;
+    if (pushed != ts_moved) {
+        ts_cancellations.push_back({type, user_data, any_user_data, pushed});
+    }
+}
+
+s64 Timing::Timer::GetNextEventBoundary() const {
+    const s64 next_time = event_queue.Front().time;
+    if (coalescing_window == 0) {
+        return next_time;
     }
+    return event_queue.GetLatestTimeUntil(next_time + coalescing_window);
 }
 
-s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
-        ASSERT(next_event->time - executed_ticks > 0);
-        return next_event->time - executed_ticks;
+s64 Timing::Timer::GetMaxSliceLength(s64 limit) const {
+    if (!event_queue.Empty()) {
+        const s64 boundary = GetNextEventBoundary();
+        ASSERT(boundary - executed_ticks > 0);
+        return boundary - executed_ticks;
     }
-    return MAX_SLICE_LENGTH;
+    return limit;
 }
 
 void Timing::Timer::Advance() {
@@ -219,12 +417,13 @@ void Timing::Timer::Advance() {
 
     is_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    while (!event_queue.Empty() && event_queue.Front().time <= executed_ticks) {
+        const Event evt = event_queue.Pop();
         if (evt.type->callback != nullptr) {
+            const auto start_time = std::chrono::steady_clock::now();
             evt.type->callback(evt.user_data, static_cast<int>(executed_ticks - evt.time));
+            evt.type->host_time += std::chrono::steady_clock::now() - start_time;
+            evt.type->num_fired++;
         } else {
             LOG_ERROR(Core, "Event '{}' has no callback", *evt.type->name);
         }
@@ -237,9 +436,9 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
     slice_length = max_slice_length;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (!event_queue.Empty()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
+            std::min<s64>(GetNextEventBoundary() - executed_ticks, max_slice_length));
     }
 
     downcount = slice_length;
@@ -24,7 +24,7 @@ namespace Kernel {
 
 void AddressArbiter::WaitThread(std::shared_ptr<Thread> thread, VAddr wait_address) {
     thread->wait_address = wait_address;
-    thread->status = ThreadStatus::WaitArb;
+    thread->SetStatus(ThreadStatus::WaitArb);
     waiting_threads.emplace_back(std::move(thread));
 }
 
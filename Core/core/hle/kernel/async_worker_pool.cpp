@@ -0,0 +1,145 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "common/thread.h"
+#include "core/hle/kernel/async_worker_pool.h"
+
+namespace Kernel {
+
+namespace {
+/// Number of small requests taken in a row before a waiting large request is taken instead.
+constexpr u32 MAX_SMALL_STREAK = 4;
+
+constexpr u32 SMALL_LANE = static_cast<u32>(AsyncLane::Small);
+constexpr u32 LARGE_LANE = static_cast<u32>(AsyncLane::Large);
+} // namespace
+
+AsyncWorkerPool::AsyncWorkerPool(std::size_t num_workers) {
+    threads.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        threads.emplace_back([this](std::stop_token stop_token) { WorkerLoop(stop_token); });
+    }
+}
+
+AsyncWorkerPool::~AsyncWorkerPool() {
+    for (auto& thread : threads) {
+        thread.request_stop();
+    }
+    threads.clear();
+}
+
+void AsyncWorkerPool::QueueWork(const AsyncHint& hint, Common::UniqueFunction<void> work) {
+    ASSERT(hint.lane != AsyncLane::Dedicated);
+    Request request{
+        .work = std::move(work),
+        .queued_at = Clock::now(),
+        .order_key = hint.order_key,
+        .lane = static_cast<u32>(hint.lane),
+    };
+    {
+        std::scoped_lock lock{mutex};
+        if (request.order_key != 0) {
+            const auto [itr, inserted] = held.try_emplace(request.order_key);
+            if (!inserted) {
+                itr->second.push_back(std::move(request));
+                num_held++;
+                return;
+            }
+        }
+        Enqueue(std::move(request));
+    }
+    condition.notify_one();
+}
+
+AsyncWorkerPool::Stats AsyncWorkerPool::GetStats() const {
+    std::scoped_lock lock{mutex};
+    Stats result{
+        .num_workers = threads.size(),
+        .num_held = num_held,
+        .lanes = stats,
+    };
+    for (u32 lane = 0; lane < NUM_LANES; lane++) {
+        result.lanes[lane].queue_depth = lanes[lane].size();
+    }
+    return result;
+}
+
+void AsyncWorkerPool::WorkerLoop(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("HLE async I/O");
+    while (!stop_token.stop_requested()) {
+        Request request;
+        {
+            std::unique_lock lock{mutex};
+            Common::CondvarWait(condition, lock, stop_token, [this] {
+                return !lanes[SMALL_LANE].empty() || !lanes[LARGE_LANE].empty();
+            });
+            if (stop_token.stop_requested()) {
+                break;
+            }
+            request = PopRequest();
+        }
+
+        const auto started_at = Clock::now();
+        request.work();
+        const auto finished_at = Clock::now();
+
+        bool released = false;
+        {
+            std::scoped_lock lock{mutex};
+            auto& lane_stats = stats[request.lane];
+            const auto wait_ns = static_cast<u64>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(started_at - request.queued_at)
+                    .count());
+            const auto run_ns = static_cast<u64>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(finished_at - started_at)
+                    .count());
+            lane_stats.completed++;
+            lane_stats.total_wait_ns += wait_ns;
+            lane_stats.max_wait_ns = std::max(lane_stats.max_wait_ns, wait_ns);
+            lane_stats.total_run_ns += run_ns;
+            lane_stats.max_run_ns = std::max(lane_stats.max_run_ns, run_ns);
+
+            if (request.order_key != 0) {
+                const auto itr = held.find(request.order_key);
+                if (itr->second.empty()) {
+                    held.erase(itr);
+                } else {
+                    Enqueue(std::move(itr->second.front()));
+                    itr->second.pop_front();
+                    num_held--;
+                    released = true;
+                }
+            }
+        }
+        if (released) {
+            condition.notify_one();
+        }
+    }
+}
+
+AsyncWorkerPool::Request AsyncWorkerPool::PopRequest() {
+    auto& small = lanes[SMALL_LANE];
+    auto& large = lanes[LARGE_LANE];
+
+    u32 lane = SMALL_LANE;
+    if (small.empty() || (!large.empty() && small_streak >= MAX_SMALL_STREAK)) {
+        lane = LARGE_LANE;
+    }
+    small_streak = (lane == SMALL_LANE && !large.empty()) ? small_streak + 1 : 0;
+
+    Request request = std::move(lanes[lane].front());
+    lanes[lane].pop_front();
+    return request;
+}
+
+void AsyncWorkerPool::Enqueue(Request request) {
+    auto& queue = lanes[request.lane];
+    auto& lane_stats = stats[request.lane];
+    queue.push_back(std::move(request));
+    lane_stats.peak_queue_depth = std::max(lane_stats.peak_queue_depth, queue.size());
+}
+
+} // namespace Kernel
@@ -115,7 +115,7 @@ std::shared_ptr<Event> HLERequestContext::SleepClientThread(
     thread->wakeup_callback = std::make_shared<ThreadCallback>(shared_from_this(), callback);
 
     auto event = kernel.CreateEvent(Kernel::ResetType::OneShot, "HLE Pause Event: " + reason);
-    thread->status = ThreadStatus::WaitHleEvent;
+    thread->SetStatus(ThreadStatus::WaitHleEvent);
     thread->wait_objects = {event};
     event->AddWaitingThread(thread);
 
@@ -359,4 +359,11 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     memory->WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+Memory::BlockSpans MappedBuffer::GetSpans(std::size_t offset, std::size_t size,
+                                          IPC::MappedBufferPermissions access) {
+    ASSERT(access != 0 && (perms & access) == access);
+    ASSERT(offset + size <= this->size);
+    return memory->GetBlockSpans(*process, address + static_cast<VAddr>(offset), size);
+}
+
 } // namespace Kernel
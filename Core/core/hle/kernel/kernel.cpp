@@ -7,6 +7,7 @@
 #include <boost/serialization/vector.hpp>
 #include "common/archives.h"
 #include "common/serialization/atomic.h"
+#include "core/hle/kernel/async_worker_pool.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/config_mem.h"
 #include "core/hle/kernel/handle_table.h"
@@ -23,6 +24,9 @@ SERIALIZE_EXPORT_IMPL(Kernel::New3dsHwCapabilities)
 
 namespace Kernel {
 
+/// Number of host threads running pooled async HLE requests, which are mostly blocking host I/O.
+constexpr std::size_t NUM_ASYNC_WORKERS = 4;
+
 /// Initialize the kernel
 KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
                            std::function<void()> prepare_reschedule_callback,
@@ -41,6 +45,7 @@ KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
     }
     timer_manager = std::make_unique<TimerManager>(timing);
     ipc_recorder = std::make_unique<IPCDebugger::Recorder>();
+    async_worker_pool = std::make_unique<AsyncWorkerPool>(NUM_ASYNC_WORKERS);
     stored_processes.assign(num_cores, nullptr);
 
     next_thread_id = 1;
@@ -151,6 +156,14 @@ const IPCDebugger::Recorder& KernelSystem::GetIPCRecorder() const {
     return *ipc_recorder;
 }
 
+AsyncWorkerPool& KernelSystem::GetAsyncWorkerPool() {
+    return *async_worker_pool;
+}
+
+const AsyncWorkerPool& KernelSystem::GetAsyncWorkerPool() const {
+    return *async_worker_pool;
+}
+
 void KernelSystem::AddNamedPort(std::string name, std::shared_ptr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
@@ -796,7 +796,7 @@ Result SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
 
         thread->wait_objects = {object};
         object->AddWaitingThread(SharedFrom(thread));
-        thread->status = ThreadStatus::WaitSynchAny;
+        thread->SetStatus(ThreadStatus::WaitSynchAny);
 
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
@@ -859,7 +859,7 @@ Result SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle_cou
         R_UNLESS(nano_seconds != 0, ResultTimeout);
 
         // Put the thread to sleep
-        thread->status = ThreadStatus::WaitSynchAll;
+        thread->SetStatus(ThreadStatus::WaitSynchAll);
 
         // Add the thread to each of the objects' waiting threads.
         for (auto& object : objects) {
@@ -901,7 +901,7 @@ Result SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle_cou
         R_UNLESS(nano_seconds != 0, ResultTimeout);
 
         // Put the thread to sleep
-        thread->status = ThreadStatus::WaitSynchAny;
+        thread->SetStatus(ThreadStatus::WaitSynchAny);
 
         // Add the thread to each of the objects' waiting threads.
         for (std::size_t i = 0; i < objects.size(); ++i) {
@@ -1041,7 +1041,7 @@ Result SVC::ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_count,
     // No objects were ready to be acquired, prepare to suspend the thread.
 
     // Put the thread to sleep
-    thread->status = ThreadStatus::WaitSynchAny;
+    thread->SetStatus(ThreadStatus::WaitSynchAny);
 
     // Add the thread to each of the objects' waiting threads.
     for (std::size_t i = 0; i < objects.size(); ++i) {
@@ -73,6 +73,10 @@ void Thread::serialize(Archive& ar, const unsigned int file_version) {
         }
     }
     ar & wakeup_callback;
+    if (Archive::is_loading::value) {
+        // The status ticks are not saved, and the timer may be behind the ticks of this session.
+        status_start_ticks = GetCurrentTicks();
+    }
 }
 SERIALIZE_IMPL(Thread)
 
@@ -89,10 +93,33 @@ void Thread::Acquire(Thread* thread) {
 }
 
 Thread::Thread(KernelSystem& kernel, u32 core_id)
-    : WaitObject(kernel), core_id(core_id), thread_manager(kernel.GetThreadManager(core_id)) {}
+    : WaitObject(kernel), core_id(core_id), thread_manager(kernel.GetThreadManager(core_id)) {
+    status_start_ticks = GetCurrentTicks();
+}
 
 Thread::~Thread() = default;
 
+u64 Thread::GetCurrentTicks() const {
+    return thread_manager.cpu ? thread_manager.cpu->GetTimer().GetTicks() : 0;
+}
+
+void Thread::SetStatus(ThreadStatus new_status) {
+    const u64 ticks = GetCurrentTicks();
+    stats.status_ticks[static_cast<std::size_t>(status)] += ticks - status_start_ticks;
+    status_start_ticks = ticks;
+    status = new_status;
+    if (new_status == ThreadStatus::Running) {
+        stats.context_switches++;
+    }
+}
+
+Thread::Stats Thread::GetStats() const {
+    Stats current = stats;
+    current.status_ticks[static_cast<std::size_t>(status)] +=
+        GetCurrentTicks() - status_start_ticks;
+    return current;
+}
+
 Thread* ThreadManager::GetCurrentThread() const {
     return current_thread.get();
 }
@@ -108,7 +135,7 @@ void Thread::Stop() {
         thread_manager.ready_queue.remove(current_priority, this);
     }
 
-    status = ThreadStatus::Dead;
+    SetStatus(ThreadStatus::Dead);
 
     WakeupAllWaitingThreads();
 
@@ -147,7 +174,7 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
             // This is only the case when a reschedule is triggered without the current thread
             // yielding execution (i.e. an event triggered, system core time-sliced, etc)
             ready_queue.push_front(previous_thread->current_priority, previous_thread);
-            previous_thread->status = ThreadStatus::Ready;
+            previous_thread->SetStatus(ThreadStatus::Ready);
         }
     }
 
@@ -162,7 +189,7 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
         current_thread = SharedFrom(new_thread);
 
         ready_queue.remove(new_thread->current_priority, new_thread);
-        new_thread->status = ThreadStatus::Running;
+        new_thread->SetStatus(ThreadStatus::Running);
 
         ASSERT(current_thread->owner_process.lock());
         if (previous_process != current_thread->owner_process.lock()) {
@@ -213,7 +240,7 @@ Thread* ThreadManager::PopNextReadyThread() {
 
 void ThreadManager::WaitCurrentThread_Sleep() {
     Thread* thread = GetCurrentThread();
-    thread->status = ThreadStatus::WaitSleep;
+    thread->SetStatus(ThreadStatus::WaitSleep);
 }
 
 void ThreadManager::ExitCurrentThread() {
@@ -247,6 +274,10 @@ void ThreadManager::TerminateProcessThreads(std::shared_ptr<Process> process) {
     }
 }
 
+bool ThreadManager::HasPendingWakeups() const {
+    return ThreadWakeupEventType->num_pending != 0;
+}
+
 void ThreadManager::ThreadWakeupCallback(u64 thread_id, s64 cycles_late) {
     std::shared_ptr<Thread> thread = SharedFrom(wakeup_callback_table.at(thread_id));
     if (thread == nullptr) {
@@ -257,6 +288,7 @@ void ThreadManager::ThreadWakeupCallback(u64 thread_id, s64 cycles_late) {
     if (thread->status == ThreadStatus::WaitSynchAny ||
         thread->status == ThreadStatus::WaitSynchAll || thread->status == ThreadStatus::WaitArb ||
         thread->status == ThreadStatus::WaitHleEvent) {
+        thread->CountWakeup(ThreadWakeupReason::Timeout);
 
         // Invoke the wakeup callback before clearing the wait objects
         if (thread->wakeup_callback)
@@ -317,7 +349,8 @@ void Thread::ResumeFromWait() {
     wakeup_callback = nullptr;
 
     thread_manager.ready_queue.push_back(current_priority, this);
-    status = ThreadStatus::Ready;
+    SetStatus(ThreadStatus::Ready);
+    stats.resumes++;
     thread_manager.kernel.PrepareReschedule();
 }
 
@@ -401,7 +434,7 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(
     if (make_ready) {
         thread_managers[processor_id]->ready_queue.push_back(thread->current_priority,
                                                              thread.get());
-        thread->status = ThreadStatus::Ready;
+        thread->SetStatus(ThreadStatus::Ready);
     }
 
     return thread;
@@ -465,7 +498,7 @@ std::shared_ptr<Thread> SetupMainThread(KernelSystem& kernel, u32 entry_point, u
         FPSCR_DEFAULT_NAN | FPSCR_FLUSH_TO_ZERO | FPSCR_ROUND_TOZERO | FPSCR_IXC; // 0x03C00010
 
     if (sleep_time_ns != 0) {
-        thread->status = ThreadStatus::WaitSleep;
+        thread->SetStatus(ThreadStatus::WaitSleep);
         thread->WakeAfterDelay(sleep_time_ns);
     }
 
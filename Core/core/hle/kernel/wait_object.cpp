@@ -47,34 +47,36 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
         waiting_threads.erase(itr);
 }
 
+bool WaitObject::IsReadyToRun(const Thread* thread) const {
+    // The list of waiting threads must not contain threads that are not waiting to be awakened.
+    ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
+                   thread->status == ThreadStatus::WaitSynchAll ||
+                   thread->status == ThreadStatus::WaitHleEvent,
+               "Inconsistent thread statuses in waiting_threads");
+
+    if (ShouldWait(thread))
+        return false;
+
+    // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
+    // in ThreadStatus::WaitSynchAll and the rest of the objects it is waiting on are ready.
+    if (thread->status == ThreadStatus::WaitSynchAll) {
+        return std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
+                            [thread](const std::shared_ptr<WaitObject>& object) {
+                                return object->ShouldWait(thread);
+                            });
+    }
+    return true;
+}
+
 std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
     Thread* candidate = nullptr;
     u32 candidate_priority = ThreadPrioLowest + 1;
 
     for (const auto& thread : waiting_threads) {
-        // The list of waiting threads must not contain threads that are not waiting to be awakened.
-        ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
-                       thread->status == ThreadStatus::WaitSynchAll ||
-                       thread->status == ThreadStatus::WaitHleEvent,
-                   "Inconsistent thread statuses in waiting_threads");
-
         if (thread->current_priority >= candidate_priority)
             continue;
 
-        if (ShouldWait(thread.get()))
-            continue;
-
-        // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
-        // in ThreadStatus::WaitSynchAll and the rest of the objects it is waiting on are ready.
-        bool ready_to_run = true;
-        if (thread->status == ThreadStatus::WaitSynchAll) {
-            ready_to_run = std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
-                                        [&thread](const std::shared_ptr<WaitObject>& object) {
-                                            return object->ShouldWait(thread.get());
-                                        });
-        }
-
-        if (ready_to_run) {
+        if (IsReadyToRun(thread.get())) {
             candidate = thread.get();
             candidate_priority = thread->current_priority;
         }
@@ -84,7 +86,34 @@ std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
-    while (auto thread = GetHighestPriorityReadyThread()) {
+    if (waiting_threads.empty()) {
+        if (hle_notifier)
+            hle_notifier();
+        return;
+    }
+
+    // Waking a thread only ever makes the objects less available, so a thread which can't be
+    // woken now can't be woken later in this call either. This allows waking the threads in one
+    // pass in priority order, instead of searching for the best ready thread after each wakeup.
+    // The sort is stable, so threads of the same priority still wake in the order they waited.
+    std::vector<std::shared_ptr<Thread>> candidates = waiting_threads;
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a->current_priority < b->current_priority;
+    });
+
+    for (auto& thread : candidates) {
+        // Threads leave waiting_threads only when they stop waiting, which an earlier wakeup
+        // callback may have caused.
+        if (thread->status != ThreadStatus::WaitSynchAny &&
+            thread->status != ThreadStatus::WaitSynchAll &&
+            thread->status != ThreadStatus::WaitHleEvent) {
+            continue;
+        }
+        if (!IsReadyToRun(thread.get())) {
+            continue;
+        }
+
+        thread->CountWakeup(ThreadWakeupReason::Signal);
         if (!thread->IsSleepingOnWaitAll()) {
             Acquire(thread.get());
         } else {
@@ -20,6 +20,63 @@ SERIALIZE_EXPORT_IMPL(Service::FS::FileSessionSlot)
 
 namespace Service::FS {
 
+/// Transfers of at least this many bytes are queued in the large lane of the async worker pool.
+constexpr std::size_t LARGE_TRANSFER_SIZE = 64 * 1024;
+
+namespace {
+
+/**
+ * Returns the guest memory of the first length bytes of the buffer, if it can be used directly.
+ * The spans are only valid until the guest runs again, so they must not be handed to the async
+ * workers.
+ */
+Memory::BlockSpans GetTransferSpans(Kernel::MappedBuffer& buffer, std::size_t length,
+                                    IPC::MappedBufferPermissions access) {
+    if (length == 0 || length > buffer.GetSize()) {
+        return {};
+    }
+    return buffer.GetSpans(0, length, access);
+}
+
+/// Reads file data straight into guest memory, stopping at the end of the file.
+ResultVal<std::size_t> ReadIntoSpans(const FileSys::FileBackend& backend, u64 offset,
+                                     const Memory::BlockSpans& spans) {
+    std::size_t total = 0;
+    for (const auto& span : spans) {
+        const auto read = backend.Read(offset + total, span.size(), span.data());
+        if (read.Failed()) {
+            return read.Code();
+        }
+        total += *read;
+        if (*read < span.size()) {
+            break;
+        }
+    }
+    return total;
+}
+
+/// Writes file data straight from guest memory. Only the last span is flushed.
+ResultVal<std::size_t> WriteFromSpans(FileSys::FileBackend& backend, u64 offset,
+                                      const Memory::BlockSpans& spans, bool flush,
+                                      bool update_timestamp) {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < spans.size(); i++) {
+        const bool last = i + 1 == spans.size();
+        const auto written = backend.Write(offset + total, spans[i].size(), flush && last,
+                                           update_timestamp, spans[i].data());
+        if (written.Failed()) {
+            return written.Code();
+        }
+        total += *written;
+        if (*written < spans[i].size()) {
+            break;
+        }
+    }
+    return total;
+}
+
+} // namespace
+
 template <class Archive>
 void File::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
@@ -79,13 +136,22 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     if (!backend->AllowsCachedReads()) {
         auto& buffer = rp.PopMappedBuffer();
         IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-        std::unique_ptr<u8[]> data = std::make_unique_for_overwrite<u8[]>(length);
-        const auto read = backend->Read(offset, length, data.get());
+        const auto spans = GetTransferSpans(buffer, length, IPC::W);
+        std::unique_ptr<u8[]> data;
+        ResultVal<std::size_t> read;
+        if (!spans.empty()) {
+            read = ReadIntoSpans(*backend, offset, spans);
+        } else {
+            data = std::make_unique_for_overwrite<u8[]>(length);
+            read = backend->Read(offset, length, data.get());
+        }
         if (read.Failed()) {
             rb.Push(read.Code());
             rb.Push<u32>(0);
         } else {
-            buffer.Write(data.get(), 0, *read);
+            if (data) {
+                buffer.Write(data.get(), 0, *read);
+            }
             rb.Push(ResultSuccess);
             rb.Push<u32>(static_cast<u32>(*read));
         }
@@ -161,7 +227,7 @@ void File::Read(Kernel::HLERequestContext& ctx) {
             }
             rb.PushMappedBuffer(*async_data->buffer);
         },
-        !async_data->cache_ready);
+        !async_data->cache_ready, GetAsyncHint(async_data->length));
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
@@ -187,10 +253,15 @@ void File::Write(Kernel::HLERequestContext& ctx) {
     bool flush = (flags & 0xFF) != 0, update_timestamp = (flags & 0xFF00) != 0;
 
     if (!backend->AllowsCachedReads()) {
-        std::vector<u8> data(length);
-        buffer.Read(data.data(), 0, data.size());
-        ResultVal<std::size_t> written =
-            backend->Write(offset, data.size(), flush, update_timestamp, data.data());
+        const auto spans = GetTransferSpans(buffer, length, IPC::R);
+        ResultVal<std::size_t> written;
+        if (!spans.empty()) {
+            written = WriteFromSpans(*backend, offset, spans, flush, update_timestamp);
+        } else {
+            std::vector<u8> data(length);
+            buffer.Read(data.data(), 0, data.size());
+            written = backend->Write(offset, data.size(), flush, update_timestamp, data.data());
+        }
 
         // Update file size
         file->size = backend->GetSize();
@@ -248,7 +319,7 @@ void File::Write(Kernel::HLERequestContext& ctx) {
             }
             rb.PushMappedBuffer(*async_data->buffer);
         },
-        true);
+        true, GetAsyncHint(async_data->length));
 }
 
 void File::GetSize(Kernel::HLERequestContext& ctx) {
@@ -292,7 +363,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(ResultSuccess);
         },
-        true);
+        true, GetAsyncHint(0));
 }
 
 void File::Close(Kernel::HLERequestContext& ctx) {
@@ -319,7 +390,7 @@ void File::Close(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(ResultSuccess);
         },
-        true);
+        true, GetAsyncHint(0));
 }
 
 void File::Flush(Kernel::HLERequestContext& ctx) {
@@ -349,7 +420,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(ResultSuccess);
         },
-        true);
+        true, GetAsyncHint(0));
 }
 
 void File::SetPriority(Kernel::HLERequestContext& ctx) {
@@ -436,6 +507,13 @@ void File::OpenSubFile(Kernel::HLERequestContext& ctx) {
     rb.PushMoveObjects(client);
 }
 
+Kernel::AsyncHint File::GetAsyncHint(std::size_t length) const {
+    return {
+        .lane = length >= LARGE_TRANSFER_SIZE ? Kernel::AsyncLane::Large : Kernel::AsyncLane::Small,
+        .order_key = reinterpret_cast<uintptr_t>(this),
+    };
+}
+
 std::shared_ptr<Kernel::ClientSession> File::Connect() {
     auto [server, client] = kernel.CreateSessionPair(GetName());
     ClientConnected(server);
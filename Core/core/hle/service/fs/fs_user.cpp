@@ -125,7 +125,7 @@ void FS_USER::OpenFile(Kernel::HLERequestContext& ctx) {
                           async_data->file_path.DebugStr());
             }
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::OpenFileDirectly(Kernel::HLERequestContext& ctx) {
@@ -242,7 +242,7 @@ void FS_USER::OpenFileDirectly(Kernel::HLERequestContext& ctx) {
                           async_data->file_path.DebugStr());
             }
         },
-        true);
+        true, {Kernel::AsyncLane::Small});
 }
 
 void FS_USER::DeleteFile(Kernel::HLERequestContext& ctx) {
@@ -285,7 +285,7 @@ void FS_USER::DeleteFile(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::RenameFile(Kernel::HLERequestContext& ctx) {
@@ -344,7 +344,7 @@ void FS_USER::RenameFile(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->src_archive_handle});
 }
 
 void FS_USER::DeleteDirectory(Kernel::HLERequestContext& ctx) {
@@ -388,7 +388,7 @@ void FS_USER::DeleteDirectory(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::DeleteDirectoryRecursively(Kernel::HLERequestContext& ctx) {
@@ -432,7 +432,7 @@ void FS_USER::DeleteDirectoryRecursively(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::CreateFile(Kernel::HLERequestContext& ctx) {
@@ -483,7 +483,7 @@ void FS_USER::CreateFile(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::CreateDirectory(Kernel::HLERequestContext& ctx) {
@@ -528,7 +528,7 @@ void FS_USER::CreateDirectory(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::RenameDirectory(Kernel::HLERequestContext& ctx) {
@@ -586,7 +586,7 @@ void FS_USER::RenameDirectory(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->src_archive_handle});
 }
 
 void FS_USER::OpenDirectory(Kernel::HLERequestContext& ctx) {
@@ -651,7 +651,7 @@ void FS_USER::OpenDirectory(Kernel::HLERequestContext& ctx) {
                 rb.PushMoveObjects<Kernel::Object>(nullptr);
             }
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::OpenArchive(Kernel::HLERequestContext& ctx) {
@@ -717,7 +717,7 @@ void FS_USER::OpenArchive(Kernel::HLERequestContext& ctx) {
                           async_data->archive_id, async_data->archive_path.DebugStr());
             }
         },
-        true);
+        true, {Kernel::AsyncLane::Small});
 }
 
 void FS_USER::ControlArchive(Kernel::HLERequestContext& ctx) {
@@ -785,7 +785,7 @@ void FS_USER::ControlArchive(Kernel::HLERequestContext& ctx) {
             }
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->handle});
 }
 
 void FS_USER::CloseArchive(Kernel::HLERequestContext& ctx) {
@@ -815,7 +815,7 @@ void FS_USER::CloseArchive(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->handle});
 }
 
 void FS_USER::IsSdmcDetected(Kernel::HLERequestContext& ctx) {
@@ -1419,7 +1419,7 @@ void FS_USER::ObsoletedSetSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small});
 }
 
 void FS_USER::ObsoletedGetSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
@@ -1473,7 +1473,7 @@ void FS_USER::ObsoletedGetSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
                 rb.Push<u64>(std::get<1>(*async_data->res)); // the secure value
             }
         },
-        true);
+        true, {Kernel::AsyncLane::Small});
 }
 
 void FS_USER::ControlSecureSave(Kernel::HLERequestContext& ctx) {
@@ -1529,7 +1529,7 @@ void FS_USER::SetThisSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small});
 }
 
 void FS_USER::GetThisSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
@@ -1581,7 +1581,7 @@ void FS_USER::GetThisSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
                 rb.Push<u64>(std::get<2>(*async_data->res));  // the secure value
             }
         },
-        true);
+        true, {Kernel::AsyncLane::Small});
 }
 
 void FS_USER::SetSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
@@ -1623,7 +1623,7 @@ void FS_USER::SetSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
             IPC::RequestBuilder rb(ctx, 1, 0);
             rb.Push(async_data->res);
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::GetSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
@@ -1677,7 +1677,7 @@ void FS_USER::GetSaveDataSecureValue(Kernel::HLERequestContext& ctx) {
                 rb.Push<u64>(std::get<2>(*async_data->res));  // the secure value
             }
         },
-        true);
+        true, {Kernel::AsyncLane::Small, async_data->archive_handle});
 }
 
 void FS_USER::RegisterProgramInfo(u32 process_id, u64 program_id, const std::string& filepath) {
@@ -1136,9 +1136,22 @@ void SOC_U::SendToOther(Kernel::HLERequestContext& ctx) {
         flags |= MSG_DONTWAIT;
     }
 #endif // _WIN32
-    std::vector<u8> input_buff(len);
-    input_mapped_buff.Read(input_buff.data(), 0,
-                           std::min(input_mapped_buff.GetSize(), static_cast<std::size_t>(len)));
+    // Send straight from guest memory when the buffer is contiguous in host memory.
+    std::vector<u8> input_buff;
+    const u8* input_data = nullptr;
+    if (len != 0 && len <= input_mapped_buff.GetSize()) {
+        const auto spans = input_mapped_buff.GetSpans(0, len, IPC::R);
+        if (spans.size() == 1) {
+            input_data = spans[0].data();
+        }
+    }
+    if (input_data == nullptr) {
+        input_buff.resize(len);
+        input_mapped_buff.Read(
+            input_buff.data(), 0,
+            std::min(input_mapped_buff.GetSize(), static_cast<std::size_t>(len)));
+        input_data = input_buff.data();
+    }
 
     s32 ret = -1;
     if (addr_len > 0) {
@@ -1146,13 +1159,12 @@ void SOC_U::SendToOther(Kernel::HLERequestContext& ctx) {
         std::memcpy(&ctr_dest_addr, dest_addr_buffer.data(),
                     std::min<size_t>(addr_len, sizeof(ctr_dest_addr)));
         auto [dest_addr, dest_addr_len] = CTRSockAddr::ToPlatform(ctr_dest_addr);
-        ret = static_cast<s32>(
-            ::sendto(holder.socket_fd, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                     reinterpret_cast<sockaddr*>(&dest_addr), dest_addr_len));
+        ret = static_cast<s32>(::sendto(holder.socket_fd, reinterpret_cast<const char*>(input_data),
+                                        len, flags, reinterpret_cast<sockaddr*>(&dest_addr),
+                                        dest_addr_len));
     } else {
-        ret = static_cast<s32>(::sendto(holder.socket_fd,
-                                        reinterpret_cast<const char*>(input_buff.data()), len,
-                                        flags, nullptr, 0));
+        ret = static_cast<s32>(::sendto(holder.socket_fd, reinterpret_cast<const char*>(input_data),
+                                        len, flags, nullptr, 0));
     }
 
     const auto send_error = (ret == SOCKET_ERROR_VALUE) ? GET_ERRNO : 0;
@@ -1308,6 +1320,8 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
         s32 ret{};
         int recv_error;
         Kernel::MappedBuffer* buffer;
+        /// Guest memory the data is received into, or null to receive into output_buff.
+        u8* output_data;
         std::vector<u8> output_buff;
         std::vector<u8> addr_buff;
     };
@@ -1318,7 +1332,19 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     async_data->len = len;
     async_data->flags = flags;
     async_data->addr_len = addr_len;
-    async_data->output_buff.resize(len);
+    async_data->output_data = nullptr;
+    // Receive straight into guest memory when the buffer is contiguous in host memory. Blocking
+    // receives run on a host thread while the guest keeps running, so they receive into
+    // output_buff and copy it into the guest from the emulator thread.
+    if (!needs_async && len != 0 && len <= buffer.GetSize()) {
+        const auto spans = buffer.GetSpans(0, len, IPC::W);
+        if (spans.size() == 1) {
+            async_data->output_data = spans[0].data();
+        }
+    }
+    if (async_data->output_data == nullptr) {
+        async_data->output_buff.resize(len);
+    }
     async_data->addr_buff.resize(addr_len);
     async_data->fd_info = &holder;
     async_data->socket_handle = socket_handle;
@@ -1337,11 +1363,13 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
             if (async_data->is_blocking) {
                 RecvBusyWaitForEvent(*async_data->fd_info);
             }
+            u8* const output_data = async_data->output_data ? async_data->output_data
+                                                            : async_data->output_buff.data();
             if (async_data->addr_len > 0) {
                 async_data->ret = static_cast<s32>(::recvfrom(
-                    async_data->fd_info->socket_fd,
-                    reinterpret_cast<char*>(async_data->output_buff.data()), async_data->len,
-                    async_data->flags, reinterpret_cast<sockaddr*>(&src_addr), &src_addr_len));
+                    async_data->fd_info->socket_fd, reinterpret_cast<char*>(output_data),
+                    async_data->len, async_data->flags, reinterpret_cast<sockaddr*>(&src_addr),
+                    &src_addr_len));
                 if (async_data->ret >= 0 && src_addr_len > 0) {
                     ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
                     std::memcpy(async_data->addr_buff.data(), &ctr_src_addr,
@@ -1349,8 +1377,7 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
                 }
             } else {
                 async_data->ret = static_cast<s32>(
-                    ::recvfrom(async_data->fd_info->socket_fd,
-                               reinterpret_cast<char*>(async_data->output_buff.data()),
+                    ::recvfrom(async_data->fd_info->socket_fd, reinterpret_cast<char*>(output_data),
                                async_data->len, async_data->flags, NULL, 0));
                 async_data->addr_buff.resize(0);
             }
@@ -1360,7 +1387,7 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
         [this, async_data](Kernel::HLERequestContext& ctx) {
             if (async_data->ret == SOCKET_ERROR_VALUE) {
                 async_data->ret = TranslateError(async_data->recv_error);
-            } else {
+            } else if (async_data->output_data == nullptr) {
                 async_data->buffer->Write(async_data->output_buff.data(), 0, async_data->ret);
             }
 #ifdef _WIN32
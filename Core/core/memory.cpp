@@ -88,9 +88,9 @@ class MemorySystem::Impl {
 public:
     // Visual Studio would try to allocate these on compile time
     // if they are std::array which would exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    std::unique_ptr<u8[]> fcram;
+    std::unique_ptr<u8[]> vram;
+    std::unique_ptr<u8[]> n3ds_extra_ram;
 
     Core::System& system;
     std::shared_ptr<PageTable> current_page_table = nullptr;
@@ -104,7 +104,7 @@ public:
     std::shared_ptr<BackingMem> n3ds_extra_ram_mem;
     std::shared_ptr<BackingMem> dsp_mem;
 
-    Impl(Core::System& system_);
+    Impl(Core::System& system_, RamStorage ram);
 
     const u8* GetPtr(Region r) const {
         switch (r) {
@@ -284,22 +284,22 @@ public:
                 return;
             }
 
-            auto& renderer = system.GPU().Renderer();
+            // Go through the GPU so that it can synchronize with its command thread first
+            auto& gpu = system.GPU();
             VAddr overlap_start = std::max(start, region_start);
             VAddr overlap_end = std::min(end, region_end);
             PAddr physical_start = paddr_region_start + (overlap_start - region_start);
             u32 overlap_size = overlap_end - overlap_start;
 
-            auto* rasterizer = renderer.Rasterizer();
             switch (mode) {
             case FlushMode::Flush:
-                rasterizer->FlushRegion(physical_start, overlap_size);
+                gpu.FlushRegion(physical_start, overlap_size);
                 break;
             case FlushMode::Invalidate:
-                rasterizer->InvalidateRegion(physical_start, overlap_size);
+                gpu.InvalidateRegion(physical_start, overlap_size);
                 break;
             case FlushMode::FlushAndInvalidate:
-                rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+                gpu.FlushAndInvalidateRegion(physical_start, overlap_size);
                 break;
             }
         };
@@ -319,11 +319,18 @@ private:
     void serialize(Archive& ar, const unsigned int file_version) {
         bool save_n3ds_ram = Settings::values.is_new_3ds.GetValue();
         ar & save_n3ds_ram;
-        ar& boost::serialization::make_binary_object(vram.get(), Memory::VRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+        const std::array<std::span<u8>, 3> ram_regions{{
+            {vram.get(), Memory::VRAM_SIZE},
+            {fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE},
+            {n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0},
+        }};
+        if (const auto& ram_state_handler = system.GetRamStateHandler()) {
+            ram_state_handler(ram_regions);
+        } else {
+            for (const auto region : ram_regions) {
+                ar& boost::serialization::make_binary_object(region.data(), region.size());
+            }
+        }
         ar & cache_marker;
         ar & page_table_list;
         // dsp is set from Core::System at startup
@@ -362,15 +369,28 @@ private:
     friend class boost::serialization::access;
 };
 
-MemorySystem::Impl::Impl(Core::System& system_)
-    : system{system_}, fcram_mem(std::make_shared<BackingMemImpl<Region::FCRAM>>(*this)),
+MemorySystem::Impl::Impl(Core::System& system_, RamStorage ram)
+    : fcram(ram.fcram ? std::move(ram.fcram) : std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE)),
+      vram(ram.vram ? std::move(ram.vram) : std::make_unique<u8[]>(Memory::VRAM_SIZE)),
+      n3ds_extra_ram(ram.n3ds_extra_ram ? std::move(ram.n3ds_extra_ram)
+                                        : std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE)),
+      system{system_}, fcram_mem(std::make_shared<BackingMemImpl<Region::FCRAM>>(*this)),
       vram_mem(std::make_shared<BackingMemImpl<Region::VRAM>>(*this)),
       n3ds_extra_ram_mem(std::make_shared<BackingMemImpl<Region::N3DS>>(*this)),
       dsp_mem(std::make_shared<BackingMemImpl<Region::DSP>>(*this)) {}
 
-MemorySystem::MemorySystem(Core::System& system) : impl(std::make_unique<Impl>(system)) {}
+MemorySystem::MemorySystem(Core::System& system, RamStorage ram)
+    : impl(std::make_unique<Impl>(system, std::move(ram))) {}
 MemorySystem::~MemorySystem() = default;
 
+RamStorage MemorySystem::ReleaseRam() {
+    return {
+        .fcram = std::move(impl->fcram),
+        .vram = std::move(impl->vram),
+        .n3ds_extra_ram = std::move(impl->n3ds_extra_ram),
+    };
+}
+
 template <class Archive>
 void MemorySystem::serialize(Archive& ar, const unsigned int file_version) {
     ar&* impl.get();
@@ -639,7 +659,31 @@ std::string MemorySystem::ReadCString(VAddr vaddr, std::size_t max_length) {
 }
 
 u8* MemorySystem::GetPhysicalPointer(PAddr address) {
-    return GetPhysicalRef(address);
+    return GetPhysicalSpan(address).data();
+}
+
+std::span<u8> MemorySystem::GetPhysicalSpan(PAddr address) {
+    // This is called from the renderer worker threads, so it must not touch the shared
+    // physical_ptr_cache or MemoryRef refcounts. All backing regions outlive the session, which
+    // makes handing out raw pointers into them safe.
+    constexpr std::array memory_areas = {
+        std::make_pair(VRAM_PADDR, Region::VRAM),
+        std::make_pair(DSP_RAM_PADDR, Region::DSP),
+        std::make_pair(FCRAM_PADDR, Region::FCRAM),
+        std::make_pair(N3DS_EXTRA_RAM_PADDR, Region::N3DS),
+    };
+
+    for (const auto& [base, region] : memory_areas) {
+        // Note: the region end check is inclusive because the user can pass in an address that
+        // represents an open right bound
+        const u32 size = impl->GetSize(region);
+        if (address >= base && address <= base + size) {
+            return {impl->GetPtr(region) + (address - base), base + size - address};
+        }
+    }
+
+    LOG_ERROR(HW_Memory, "Unknown GetPhysicalPointer @ {:#08X}", address);
+    return {};
 }
 
 MemoryRef MemorySystem::GetPhysicalRef(PAddr address) {
@@ -874,6 +918,35 @@ void MemorySystem::WriteBlock(const VAddr dest_addr, const void* src_buffer,
     return impl->WriteBlockImpl<false>(process, dest_addr, src_buffer, size);
 }
 
+BlockSpans MemorySystem::GetBlockSpans(const Kernel::Process& process, const VAddr addr,
+                                       const std::size_t size) {
+    auto& page_table = *process.vm_manager.page_table;
+    BlockSpans spans;
+    std::size_t remaining_size = size;
+    std::size_t page_index = addr >> CITRA_PAGE_BITS;
+    std::size_t page_offset = addr & CITRA_PAGE_MASK;
+
+    while (remaining_size > 0) {
+        const std::size_t span_size = std::min(CITRA_PAGE_SIZE - page_offset, remaining_size);
+        if (page_index >= PAGE_TABLE_NUM_ENTRIES ||
+            page_table.attributes[page_index] != PageType::Memory) {
+            return {};
+        }
+
+        u8* const host_ptr = page_table.pointers[page_index] + page_offset;
+        if (!spans.empty() && spans.back().data() + spans.back().size() == host_ptr) {
+            spans.back() = {spans.back().data(), spans.back().size() + span_size};
+        } else {
+            spans.emplace_back(host_ptr, span_size);
+        }
+
+        page_index++;
+        page_offset = 0;
+        remaining_size -= span_size;
+    }
+    return spans;
+}
+
 void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_addr,
                              const std::size_t size) {
     auto& page_table = *process.vm_manager.page_table;
@@ -72,6 +72,22 @@ void PerfStats::EndGPUProcessing() {
     accumulated_gpu_time += (Clock::now() - start_gpu_time);
 }
 
+void PerfStats::BeginCPUProcessing() {
+    start_cpu_time = Clock::now();
+}
+
+void PerfStats::EndCPUProcessing() {
+    accumulated_cpu_time += (Clock::now() - start_cpu_time);
+}
+
+void PerfStats::BeginDSPProcessing() {
+    start_dsp_time = Clock::now();
+}
+
+void PerfStats::EndDSPProcessing() {
+    accumulated_dsp_time += (Clock::now() - start_dsp_time);
+}
+
 void PerfStats::StartSwap() {
     start_swap_time = Clock::now();
 }
@@ -84,6 +100,7 @@ void PerfStats::BeginSystemFrame() {
     std::scoped_lock lock{object_mutex};
 
     frame_begin = Clock::now();
+    accumulated_idle_time += frame_begin - previous_frame_end;
 }
 
 void PerfStats::EndSystemFrame() {
@@ -111,6 +128,21 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::BeginRunFrame() {
+    std::scoped_lock lock{object_mutex};
+
+    if (run_frame_end) {
+        accumulated_frontend_time += Clock::now() - *run_frame_end;
+        run_frame_end.reset();
+    }
+}
+
+void PerfStats::EndRunFrame() {
+    std::scoped_lock lock{object_mutex};
+
+    run_frame_end = Clock::now();
+}
+
 double PerfStats::GetMeanFrametime() const {
     std::scoped_lock lock{object_mutex};
 
@@ -156,12 +188,30 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
                                   static_cast<double>(system_frames))
                                : 0;
 
+    last_stats.time_cpu =
+        system_frames
+            ? (duration_cast<DoubleSecs>(accumulated_cpu_time - accumulated_svc_time).count() /
+               static_cast<double>(system_frames))
+            : 0;
+    last_stats.time_dsp = system_frames
+                              ? (duration_cast<DoubleSecs>(accumulated_dsp_time).count() /
+                                 static_cast<double>(system_frames))
+                              : 0;
+
     last_stats.time_remaining =
-        system_frames ? (duration_cast<DoubleSecs>((accumulated_frametime - accumulated_svc_time) -
-                                                   accumulated_swap_time)
-                             .count() /
-                         static_cast<double>(system_frames))
-                      : 0;
+        system_frames
+            ? (duration_cast<DoubleSecs>(accumulated_frametime - accumulated_cpu_time -
+                                         accumulated_dsp_time - accumulated_swap_time -
+                                         accumulated_frontend_time)
+                   .count() /
+               static_cast<double>(system_frames))
+            : 0;
+    last_stats.time_idle =
+        system_frames
+            ? (duration_cast<DoubleSecs>(accumulated_idle_time + accumulated_frontend_time)
+                   .count() /
+               static_cast<double>(system_frames))
+            : 0;
     last_stats.emulation_speed = system_us_per_second.count() / 1'000'000.0;
     last_stats.artic_transmitted = static_cast<double>(artic_transmitted) / interval;
     last_stats.artic_events.raw = artic_events.raw | prev_artic_event.raw;
@@ -175,6 +225,10 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     accumulated_ipc_time = Clock::duration::zero();
     accumulated_gpu_time = Clock::duration::zero();
     accumulated_swap_time = Clock::duration::zero();
+    accumulated_cpu_time = Clock::duration::zero();
+    accumulated_dsp_time = Clock::duration::zero();
+    accumulated_idle_time = Clock::duration::zero();
+    accumulated_frontend_time = Clock::duration::zero();
     game_frames = 0;
     artic_transmitted = 0;
     prev_artic_event.raw &= artic_events.raw;
@@ -0,0 +1,377 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/vector.hpp>
+#include "common/archives.h"
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "common/zstd_compression.h"
+#include "core/core.h"
+#include "core/rewind_buffer.h"
+
+namespace Core {
+
+namespace {
+/// Pages compressed together. Bounds the temporary copy made while capturing a keyframe.
+constexpr std::size_t PAGES_PER_CHUNK = 256;
+
+/// Captures happen every few frames, so favour speed over ratio.
+constexpr s32 COMPRESSION_LEVEL = 1;
+
+constexpr std::size_t PAGE_SIZE = RewindBuffer::PAGE_SIZE;
+
+constinit const std::array<u8, PAGE_SIZE> zero_page{};
+
+bool IsZeroPage(const u8* page, u64 hash) {
+    static const u64 zero_page_hash = Common::ComputeHash64(zero_page.data(), PAGE_SIZE);
+    return hash == zero_page_hash && std::memcmp(page, zero_page.data(), PAGE_SIZE) == 0;
+}
+
+/// Returns the host pointer of a page, counting the pages of all regions in order.
+u8* GetPage(std::span<const std::span<u8>> regions, std::size_t index) {
+    std::size_t offset = index * PAGE_SIZE;
+    for (const auto region : regions) {
+        if (offset < region.size()) {
+            return region.data() + offset;
+        }
+        offset -= region.size();
+    }
+    throw std::runtime_error("Rewind state refers to a page outside of the emulated RAM");
+}
+
+/// Returns the number of bytes the rewind_buffer_size setting allows the states to take.
+std::size_t GetBudget() {
+    return static_cast<std::size_t>(Settings::values.rewind_buffer_size.GetValue()) * 1024 * 1024;
+}
+
+std::size_t CountPages(std::span<const std::span<u8>> regions) {
+    std::size_t num_pages = 0;
+    for (const auto region : regions) {
+        num_pages += region.size() / PAGE_SIZE;
+    }
+    return num_pages;
+}
+} // namespace
+
+std::size_t RewindBuffer::State::Size() const {
+    std::size_t size = sizeof(State) + system_data.size() + page_indices.size() * sizeof(u32) +
+                       page_hashes.size() * sizeof(u64);
+    for (const auto& chunk : page_chunks) {
+        size += sizeof(chunk) + chunk.size();
+    }
+    return size;
+}
+
+template <class Archive>
+void RewindBuffer::State::serialize(Archive& ar, const unsigned int) {
+    ar & is_keyframe;
+    ar & region_sizes;
+    ar & system_data;
+    ar & page_indices;
+    ar & page_chunks;
+}
+
+RewindBuffer::RewindBuffer(System& system_) : system{system_} {}
+
+RewindBuffer::~RewindBuffer() = default;
+
+bool RewindBuffer::IsEnabled() const {
+    return Settings::values.rewind_buffer_size.GetValue() != 0;
+}
+
+u64 RewindBuffer::Capture() {
+    const u32 keyframe_interval = Settings::values.rewind_keyframe_interval.GetValue();
+    const State* base = nullptr;
+    if (!states.empty()) {
+        const auto keyframe = std::find_if(states.rbegin(), states.rend(),
+                                           [](const State& state) { return state.is_keyframe; });
+        const auto num_deltas = static_cast<u32>(std::distance(states.rbegin(), keyframe));
+        if (num_deltas + 1 < keyframe_interval) {
+            base = &*keyframe;
+        }
+    }
+
+    State state = Save(base);
+    state.id = next_id++;
+    last_pages = state.page_indices.size();
+    last_bytes = state.Size();
+    used_bytes += last_bytes;
+    captured++;
+    states.push_back(std::move(state));
+
+    Evict(GetBudget());
+    return states.back().id;
+}
+
+bool RewindBuffer::Restore(u64 id) {
+    const auto itr = Find(id);
+    if (itr == states.end()) {
+        return false;
+    }
+    Load(*itr, itr->is_keyframe ? nullptr : &KeyframeOf(itr));
+    return true;
+}
+
+bool RewindBuffer::Contains(u64 id) const {
+    return Find(id) != states.end();
+}
+
+void RewindBuffer::Clear() {
+    states.clear();
+    used_bytes = 0;
+}
+
+void RewindBuffer::ApplyBudget() {
+    if (!IsEnabled()) {
+        Clear();
+        return;
+    }
+    Evict(GetBudget());
+}
+
+std::vector<u8> RewindBuffer::SaveStandalone() {
+    State state = Save(nullptr);
+    state.page_hashes.clear();
+
+    std::ostringstream sstream{std::ios_base::binary};
+    {
+        oarchive oa{sstream};
+        oa & state;
+    }
+    const std::string& str = sstream.str();
+    return {str.begin(), str.end()};
+}
+
+void RewindBuffer::LoadStandalone(std::span<const u8> data) {
+    State state;
+    {
+        std::istringstream sstream{
+            std::string{reinterpret_cast<const char*>(data.data()), data.size()},
+            std::ios_base::binary};
+        iarchive ia{sstream};
+        ia & state;
+    }
+    if (!state.is_keyframe) {
+        throw std::runtime_error("Standalone state is not a keyframe");
+    }
+    Load(state, nullptr);
+}
+
+RewindBuffer::Stats RewindBuffer::GetStats() const {
+    return {
+        .budget = GetBudget(),
+        .used_bytes = used_bytes,
+        .num_states = states.size(),
+        .num_keyframes = static_cast<std::size_t>(std::count_if(
+            states.begin(), states.end(), [](const State& state) { return state.is_keyframe; })),
+        .last_pages = last_pages,
+        .last_bytes = last_bytes,
+        .captured = captured,
+        .evicted = evicted,
+    };
+}
+
+RewindBuffer::State RewindBuffer::Save(const State* base) {
+    State state{};
+    state.is_keyframe = base == nullptr;
+
+    std::vector<u8> chunk;
+    const auto flush_chunk = [&] {
+        if (!chunk.empty()) {
+            state.page_chunks.push_back(
+                Common::Compression::CompressDataZSTD(chunk, COMPRESSION_LEVEL));
+            chunk.clear();
+        }
+    };
+
+    // The system calls this after flushing the rasterizer caches, at the point where the RAM
+    // would otherwise be written into the archive.
+    system.SetRamStateHandler([&](std::span<const std::span<u8>> regions) {
+        ASSERT(regions.size() == NUM_REGIONS);
+        for (std::size_t i = 0; i < NUM_REGIONS; i++) {
+            state.region_sizes[i] = static_cast<u32>(regions[i].size());
+        }
+        if (base && base->region_sizes != state.region_sizes) {
+            throw std::runtime_error("Emulated RAM layout changed since the rewind keyframe");
+        }
+
+        const std::size_t num_pages = CountPages(regions);
+        if (state.is_keyframe) {
+            state.page_hashes.resize(num_pages);
+        }
+        chunk.reserve(PAGES_PER_CHUNK * PAGE_SIZE);
+        for (std::size_t index = 0; index < num_pages; index++) {
+            const u8* page = GetPage(regions, index);
+            const u64 hash = Common::ComputeHash64(page, PAGE_SIZE);
+            bool changed;
+            if (state.is_keyframe) {
+                state.page_hashes[index] = hash;
+                changed = !IsZeroPage(page, hash);
+            } else {
+                changed = base->page_hashes[index] != hash;
+            }
+            if (!changed) {
+                continue;
+            }
+            state.page_indices.push_back(static_cast<u32>(index));
+            if (!state.is_keyframe) {
+                state.page_hashes.push_back(hash);
+            }
+            chunk.insert(chunk.end(), page, page + PAGE_SIZE);
+            if (chunk.size() == PAGES_PER_CHUNK * PAGE_SIZE) {
+                flush_chunk();
+            }
+        }
+        flush_chunk();
+    });
+    SCOPE_EXIT({ system.SetRamStateHandler({}); });
+
+    std::ostringstream sstream{std::ios_base::binary};
+    {
+        oarchive oa{sstream};
+        oa & system;
+    }
+    const std::string& str = sstream.str();
+    state.system_data = Common::Compression::CompressDataZSTD(
+        std::span{reinterpret_cast<const u8*>(str.data()), str.size()}, COMPRESSION_LEVEL);
+    return state;
+}
+
+void RewindBuffer::Load(const State& state, const State* keyframe) {
+    if (keyframe && keyframe->region_sizes != state.region_sizes) {
+        throw std::runtime_error("Rewind state does not match the RAM layout of its keyframe");
+    }
+
+    system.SetRamStateHandler([&](std::span<const std::span<u8>> regions) {
+        ASSERT(regions.size() == NUM_REGIONS);
+        for (std::size_t i = 0; i < NUM_REGIONS; i++) {
+            if (regions[i].size() != state.region_sizes[i]) {
+                throw std::runtime_error("Rewind state does not match the emulated RAM layout");
+            }
+        }
+
+        // The regions still hold the RAM from before the load, so only the pages that differ
+        // from the state have to be written. Without hashes, as in standalone states, every
+        // page is written.
+        const std::size_t num_pages = CountPages(regions);
+        const State& base = keyframe ? *keyframe : state;
+        std::vector<bool> pending(num_pages, true);
+        if (base.page_hashes.size() == num_pages) {
+            std::vector<u64> hashes = base.page_hashes;
+            if (keyframe) {
+                ASSERT(state.page_hashes.size() == state.page_indices.size());
+                for (std::size_t i = 0; i < state.page_indices.size(); i++) {
+                    hashes.at(state.page_indices[i]) = state.page_hashes[i];
+                }
+            }
+            for (std::size_t index = 0; index < num_pages; index++) {
+                pending[index] =
+                    Common::ComputeHash64(GetPage(regions, index), PAGE_SIZE) != hashes[index];
+            }
+        }
+
+        // Writes the pending pages stored by a state, decompressing only the chunks that hold
+        // any of them.
+        const auto apply_pages = [&](const State& pages) {
+            std::size_t first = 0;
+            for (const auto& compressed : pages.page_chunks) {
+                if (first >= pages.page_indices.size()) {
+                    throw std::runtime_error("Rewind state has more pages than page indices");
+                }
+                const auto indices = std::span{pages.page_indices}.subspan(
+                    first, std::min(PAGES_PER_CHUNK, pages.page_indices.size() - first));
+                first += indices.size();
+                if (std::none_of(indices.begin(), indices.end(), [&](u32 index) {
+                        return index >= num_pages || pending[index];
+                    })) {
+                    continue;
+                }
+
+                const auto chunk = Common::Compression::DecompressDataZSTD(compressed);
+                if (chunk.size() != indices.size() * PAGE_SIZE) {
+                    throw std::runtime_error("Rewind state has a chunk of the wrong size");
+                }
+                for (std::size_t i = 0; i < indices.size(); i++) {
+                    const std::size_t index = indices[i];
+                    if (index >= num_pages) {
+                        throw std::runtime_error(
+                            "Rewind state refers to a page outside of the emulated RAM");
+                    }
+                    if (pending[index]) {
+                        std::memcpy(GetPage(regions, index), chunk.data() + i * PAGE_SIZE,
+                                    PAGE_SIZE);
+                        pending[index] = false;
+                    }
+                }
+            }
+        };
+
+        // A delta goes first, so that the keyframe does not write the pages it replaces.
+        apply_pages(state);
+        if (keyframe) {
+            apply_pages(*keyframe);
+        }
+        // Keyframes leave out the pages that are all zeroes.
+        for (std::size_t index = 0; index < num_pages; index++) {
+            if (pending[index]) {
+                std::memset(GetPage(regions, index), 0, PAGE_SIZE);
+            }
+        }
+    });
+    SCOPE_EXIT({ system.SetRamStateHandler({}); });
+
+    const auto decompressed = Common::Compression::DecompressDataZSTD(state.system_data);
+    std::istringstream sstream{
+        std::string{reinterpret_cast<const char*>(decompressed.data()), decompressed.size()},
+        std::ios_base::binary};
+    iarchive ia{sstream};
+    ia & system;
+}
+
+std::deque<RewindBuffer::State>::const_iterator RewindBuffer::Find(u64 id) const {
+    // Identifiers only grow, so the states are sorted by them.
+    const auto itr = std::lower_bound(states.begin(), states.end(), id,
+                                      [](const State& state, u64 id) { return state.id < id; });
+    return itr != states.end() && itr->id == id ? itr : states.end();
+}
+
+const RewindBuffer::State& RewindBuffer::KeyframeOf(
+    std::deque<State>::const_iterator state) const {
+    while (!state->is_keyframe) {
+        ASSERT(state != states.begin());
+        --state;
+    }
+    return *state;
+}
+
+void RewindBuffer::Evict(std::size_t budget) {
+    while (used_bytes > budget) {
+        // Keep the most recent keyframe, so that the state just captured stays restorable.
+        const auto next_keyframe =
+            std::find_if(std::next(states.begin()), states.end(),
+                         [](const State& state) { return state.is_keyframe; });
+        if (next_keyframe == states.end()) {
+            break;
+        }
+        for (auto itr = states.begin(); itr != next_keyframe; ++itr) {
+            used_bytes -= itr->Size();
+            evicted++;
+        }
+        states.erase(states.begin(), next_keyframe);
+    }
+    if (used_bytes > budget) {
+        LOG_DEBUG(Core, "Rewind states take {} bytes, over the budget of {} bytes", used_bytes,
+                  budget);
+    }
+}
+
+} // namespace Core
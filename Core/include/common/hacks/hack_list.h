@@ -14,6 +14,7 @@ enum class HackType : int {
     DECRYPTION_AUTHORIZED,
     ONLINE_LLE_REQUIRED,
     REGION_FROM_SECURE,
+    SKIP_IDLE_LOOPS,
 };
 
 class UserHackData {};
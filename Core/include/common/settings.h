@@ -458,6 +458,18 @@ struct Values {
     // Core
     Setting<bool> use_cpu_jit{true, "use_cpu_jit"};
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
+    /// Maximum size of the translation cache of each interpreter core, in MiB
+    Setting<u32, true> dyncom_cache_size{32, 4, 512, "dyncom_cache_size"};
+    /// Skip to the next event when the interpreter finds a loop that only polls memory
+    SwitchableSetting<bool> skip_idle_loops{true, "skip_idle_loops"};
+    /// Run each interpreter core on its own host thread. Execution is no longer deterministic.
+    Setting<bool> parallel_cpu_cores{false, "parallel_cpu_cores"};
+    /// Events due within this many microseconds of the next event share its slice boundary
+    Setting<u32, true> event_coalescing_window{0, 0, 1000, "event_coalescing_window"};
+    /// Memory kept for in-memory rewind states, in MiB. 0 disables capturing them.
+    Setting<u32, true> rewind_buffer_size{0, 0, 4096, "rewind_buffer_size"};
+    /// A rewind state stores all of the RAM every this many states, and only changes otherwise
+    Setting<u32, true> rewind_keyframe_interval{30, 1, 600, "rewind_keyframe_interval"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
     SwitchableSetting<bool> lle_applets{true, "lle_applets"};
     SwitchableSetting<bool> deterministic_async_operations{false, "deterministic_async_operations"};
@@ -501,6 +513,7 @@ struct Values {
     SwitchableSetting<bool> disable_spirv_optimizer{true, "disable_spirv_optimizer"};
     SwitchableSetting<bool> async_shader_compilation{false, "async_shader_compilation"};
     SwitchableSetting<bool> async_presentation{true, "async_presentation"};
+    SwitchableSetting<bool> use_gpu_thread{false, "use_gpu_thread"};
     SwitchableSetting<bool> use_hw_shader{true, "use_hw_shader"};
     SwitchableSetting<bool> use_disk_shader_cache{true, "use_disk_shader_cache"};
     SwitchableSetting<bool> shaders_accurate_mul{true, "shaders_accurate_mul"};
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
@@ -24,15 +25,13 @@ struct ThreadQueueList {
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    ThreadQueueList() = default;
 
     // Only for debugging, returns priority level.
     [[nodiscard]] Priority contains(const T& uid) const {
         for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
+            const std::deque<T>& cur = queues[i];
+            if (std::find(cur.cbegin(), cur.cend(), uid) != cur.cend()) {
                 return i;
             }
         }
@@ -41,54 +40,40 @@ struct ThreadQueueList {
     }
 
     [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+        const Priority priority = first_nonempty(NUM_QUEUES);
+        if (priority == NUM_QUEUES) {
+            return T();
         }
-
-        return T();
+        return queues[priority].front();
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+        return pop_first_better(NUM_QUEUES);
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        const Priority first = first_nonempty(priority);
+        if (first == NUM_QUEUES) {
+            return T();
         }
 
-        return T();
+        std::deque<T>& cur = queues[first];
+        auto tmp = std::move(cur.front());
+        cur.pop_front();
+        if (cur.empty()) {
+            clear_bit(nonempty_mask, first);
+        }
+        return tmp;
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        queues[priority].push_front(thread_id);
+        set_bit(nonempty_mask, priority);
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        queues[priority].push_back(thread_id);
+        set_bit(nonempty_mask, priority);
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
@@ -98,110 +83,107 @@ struct ThreadQueueList {
     }
 
     void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+        std::deque<T>& cur = queues[priority];
+        const auto iter = std::remove(cur.begin(), cur.end(), thread_id);
+        cur.erase(iter, cur.end());
+        if (cur.empty()) {
+            clear_bit(nonempty_mask, priority);
+        }
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
+        std::deque<T>& cur = queues[priority];
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        if (cur.size() > 1) {
+            cur.push_back(std::move(cur.front()));
+            cur.pop_front();
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        queues.fill({});
+        nonempty_mask.fill(0);
+        used_mask.fill(0);
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
+        return queues[priority].empty();
     }
 
     void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        set_bit(used_mask, priority);
     }
 
 private:
-    struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
-    };
-
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
-    }
-
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
+    static constexpr std::size_t NUM_WORDS = (N + 63) / 64;
+    using Mask = std::array<u64, NUM_WORDS>;
 
-        cur->next_nonempty = first;
-        first = cur;
+    static void set_bit(Mask& mask, Priority priority) {
+        mask[priority / 64] |= u64{1} << (priority % 64);
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
-
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
-        } else {
-            return q - queues.data();
-        }
+    static void clear_bit(Mask& mask, Priority priority) {
+        mask[priority / 64] &= ~(u64{1} << (priority % 64));
+    }
+
+    static bool test_bit(const Mask& mask, Priority priority) {
+        return (mask[priority / 64] >> (priority % 64)) & 1;
     }
 
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
-        } else {
-            return &queues[idx];
+    /// Returns the best priority level below the given one with a queued thread, or NUM_QUEUES.
+    [[nodiscard]] Priority first_nonempty(Priority limit) const {
+        for (std::size_t word = 0; word < NUM_WORDS; word++) {
+            if (nonempty_mask[word] != 0) {
+                const auto priority =
+                    static_cast<Priority>(word * 64 + std::countr_zero(nonempty_mask[word]));
+                return priority < limit ? priority : NUM_QUEUES;
+            }
         }
+        return NUM_QUEUES;
     }
 
+    // The priority level queues of thread ids.
+    std::array<std::deque<T>, NUM_QUEUES> queues;
+    // Priority levels with at least one queued thread.
+    Mask nonempty_mask{};
+    // Priority levels that have been prepared. These are only tracked to keep the save state
+    // format, which stores them as a list of the used levels.
+    Mask used_mask{};
+
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
-        ar << idx;
+        // The used levels were linked in priority order, with -1 marking unused levels and -2
+        // ending the list.
+        s64 next = -2;
+        std::array<s64, NUM_QUEUES> next_used;
+        for (Priority i = NUM_QUEUES; i-- > 0;) {
+            next_used[i] = test_bit(used_mask, i) ? next : -1;
+            if (test_bit(used_mask, i)) {
+                next = i;
+            }
+        }
+        ar << next;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
-            ar << idx1;
-            ar << queues[i].data;
+            ar << next_used[i];
+            ar << queues[i];
         }
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int file_version) {
+        clear();
         s64 idx;
         ar >> idx;
-        first = ToPointer(idx);
-        for (std::size_t i = 0; i < NUM_QUEUES; i++) {
+        for (Priority i = 0; i < NUM_QUEUES; i++) {
             ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            ar >> queues[i];
+            if (idx != -1) {
+                set_bit(used_mask, i);
+            }
+            if (!queues[i].empty()) {
+                set_bit(nonempty_mask, i);
+            }
         }
     }
 
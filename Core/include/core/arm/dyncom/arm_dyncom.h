@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
@@ -51,14 +55,39 @@ public:
     void SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) override;
     void PrepareReschedule() override;
 
+    /// Returns memory use and hit rate counters of the translation cache of this core.
+    TranslationCache::Stats GetTranslationCacheStats() const;
+
+    /// Returns the number of cycles skipped because the core was waiting in an idle loop.
+    u64 GetSkippedIdleCycles() const {
+        return skipped_idle_cycles;
+    }
+
 protected:
     std::shared_ptr<Memory::PageTable> GetPageTable() const override;
 
 private:
     void ExecuteInstructions(u64 num_instructions);
+    void ApplyPendingChanges();
+    void UpdatePageTable(const std::shared_ptr<Memory::PageTable>& page_table);
 
     Core::System& system;
     std::unique_ptr<ARMul_State> state;
+    /// Keeps the page table whose pointers the interpreter accesses directly alive.
+    std::shared_ptr<Memory::PageTable> current_page_table;
+    u64 skipped_idle_cycles = 0;
+
+    /// Changes requested by another core while this one runs on its own host thread. They are
+    /// applied before this core executes its next slice.
+    struct PendingChanges {
+        bool clear_cache = false;
+        std::vector<std::pair<u32, std::size_t>> invalidated_ranges;
+        std::shared_ptr<Memory::PageTable> page_table;
+        bool set_page_table = false;
+    };
+    std::mutex pending_mutex;
+    PendingChanges pending_changes;
+    std::atomic_bool has_pending_changes = false;
 };
 
 } // namespace Core
@@ -0,0 +1,144 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * Storage for the translated blocks of one dyncom core. Blocks are kept in fixed size chunks
+ * which are allocated on demand up to a configurable limit. Once the limit is reached, the
+ * oldest chunk is evicted along with every block in it, so that the cache never overflows.
+ */
+class TranslationCache {
+public:
+    static constexpr std::size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+    struct Stats {
+        std::size_t capacity;       ///< Maximum number of bytes the cache may allocate
+        std::size_t reserved_bytes; ///< Bytes currently allocated for chunks
+        std::size_t used_bytes;     ///< Bytes taken by cached blocks
+        std::size_t num_blocks;     ///< Number of cached blocks
+        u64 hits;                   ///< Block lookups that found a translated block
+        u64 misses;                 ///< Block lookups that required a translation
+        u64 evictions;              ///< Number of chunks evicted to make room for new blocks
+    };
+
+    /**
+     * Successor of a block, remembered by the direct branch that ends it so that the next
+     * dispatch through that branch can skip the lookup. A link is only followed while no block
+     * has been dropped since it was made, so that it never refers to a dropped block.
+     */
+    struct Link {
+        u32 addr;
+        char* entry;
+        u64 generation;
+    };
+
+    explicit TranslationCache(std::size_t capacity);
+    ~TranslationCache();
+
+    /// Returns the translated block starting at the given guest address, or nullptr.
+    char* Find(u32 addr) {
+        auto& fast_entry = fast_lookup[(addr >> 1) & (FAST_LOOKUP_SIZE - 1)];
+        if (fast_entry.addr == addr && fast_entry.entry != nullptr) {
+            hits++;
+            return fast_entry.entry;
+        }
+
+        const auto itr = blocks.find(addr);
+        if (itr == blocks.end()) {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        fast_entry = {addr, itr->second.entry};
+        return itr->second.entry;
+    }
+
+    /// Returns the number of times blocks have been dropped, which invalidates all links.
+    u64 GetGeneration() const {
+        return generation;
+    }
+
+    /// Returns whether the link may be followed to reach the block at the given address.
+    bool IsLinked(const Link& link, u32 addr) const {
+        return link.addr == addr && link.entry != nullptr && link.generation == generation;
+    }
+
+    void SetLink(Link& link, u32 addr, char* entry) const {
+        link = {addr, entry, generation};
+    }
+
+    /**
+     * Copies a translated block into the cache, replacing any block previously cached at the
+     * same address.
+     * @param addr Guest address of the first instruction of the block
+     * @param end_addr Guest address one past the last instruction of the block
+     * @param code Translated instructions of the block
+     * @param size Size of the translated instructions in bytes
+     * @return Pointer to the cached copy of the block
+     */
+    char* Insert(u32 addr, u32 end_addr, const char* code, std::size_t size);
+
+    /// Drops the blocks which contain guest code in the given range.
+    void Invalidate(u32 start_address, std::size_t length);
+
+    /**
+     * Drops all blocks. The chunks stay allocated, as this may be called while the core is still
+     * executing one of the dropped blocks.
+     */
+    void Clear();
+
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    struct Block {
+        char* entry;      ///< Location of the block in its chunk
+        std::size_t size; ///< Size of the block in its chunk
+        u32 end_addr;     ///< Guest address one past the last translated instruction
+        u32 chunk;        ///< Index of the chunk holding the block
+    };
+
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        std::size_t top = 0;
+        /// Space of dropped blocks below top, as offset -> size. Adjacent holes are merged.
+        std::map<std::size_t, std::size_t> holes;
+    };
+
+    struct FastLookupEntry {
+        u32 addr;
+        char* entry;
+    };
+    static constexpr std::size_t FAST_LOOKUP_SIZE = 4096;
+
+    Block Allocate(std::size_t size);
+    void Release(u32 addr, const Block& block);
+    void Drop(u32 addr);
+    void EvictChunk(u32 index);
+
+    std::size_t capacity;
+    std::vector<Chunk> chunks;
+    /// Chunk new blocks are appended to once no hole fits them
+    u32 current_chunk = 0;
+
+    /// Direct-mapped cache of recent lookups in front of blocks
+    std::array<FastLookupEntry, FAST_LOOKUP_SIZE> fast_lookup{};
+    std::unordered_map<u32, Block> blocks;
+    /// Start addresses of the cached blocks, grouped by the guest page they start in.
+    std::unordered_map<u32, std::vector<u32>> pages;
+
+    std::size_t used_bytes = 0;
+    u64 generation = 0;
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 evictions = 0;
+};
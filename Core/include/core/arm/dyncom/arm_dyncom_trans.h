@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include "common/common_types.h"
+#include "core/arm/dyncom/arm_dyncom_cache.h"
 
 struct ARMul_State;
 typedef unsigned int (*shtop_fp_t)(ARMul_State* cpu, unsigned int sht_oper);
@@ -88,6 +89,8 @@ struct bbl_inst {
     int signed_immed_24;
     unsigned int next_addr;
     unsigned int jmp_addr;
+    TranslationCache::Link link;
+    bool idle_loop; // Branches back to the start of a block that only polls memory
 };
 
 struct bx_inst {
@@ -451,10 +454,14 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    TranslationCache::Link link;
+    bool idle_loop;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    TranslationCache::Link link;
+    bool idle_loop;
 };
 
 struct bl_1_thumb {
@@ -462,6 +469,7 @@ struct bl_1_thumb {
 };
 struct bl_2_thumb {
     unsigned int imm;
+    TranslationCache::Link link;
 };
 struct blx_1_thumb {
     unsigned int imm;
@@ -493,6 +501,11 @@ typedef ARM_INST_PTR (*transop_fp_t)(unsigned int, int);
 extern const transop_fp_t arm_instruction_trans[];
 extern const std::size_t arm_instruction_trans_len;
 
-#define TRANS_CACHE_SIZE (64 * 1024 * 2000)
-extern char trans_cache_buf[TRANS_CACHE_SIZE];
-extern std::size_t trans_cache_buf_top;
+// Upper bound of the size of one translated block. A block never crosses a guest page, so it
+// holds at most 2048 Thumb instructions.
+#define TRANS_STAGING_SIZE (1024 * 1024)
+
+/// Starts translating a new block, returning where its first instruction will be placed.
+char* BeginTransBlock();
+/// Returns the size of the instructions translated since the last call to BeginTransBlock.
+std::size_t GetTransBlockSize();
@@ -18,10 +18,14 @@
 #pragma once
 
 #include <array>
-#include <unordered_map>
+#include <cstring>
+#include "common/atomic_ops.h"
 #include "common/common_types.h"
+#include "common/swap.h"
+#include "core/arm/dyncom/arm_dyncom_cache.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/memory.h"
 
 namespace Core {
 class System;
@@ -155,14 +159,30 @@ public:
 
     // Reads/writes data in big/little endian format based on the
     // state of the E (endian) bit in the APSR.
-    u8 ReadMemory8(u32 address) const;
-    u16 ReadMemory16(u32 address) const;
-    u32 ReadMemory32(u32 address) const;
-    u64 ReadMemory64(u32 address) const;
-    void WriteMemory8(u32 address, u8 data);
-    void WriteMemory16(u32 address, u16 data);
-    void WriteMemory32(u32 address, u32 data);
-    void WriteMemory64(u32 address, u64 data);
+    u8 ReadMemory8(u32 address) const {
+        return ReadMemory<u8>(address);
+    }
+    u16 ReadMemory16(u32 address) const {
+        return ReadMemory<u16>(address);
+    }
+    u32 ReadMemory32(u32 address) const {
+        return ReadMemory<u32>(address);
+    }
+    u64 ReadMemory64(u32 address) const {
+        return ReadMemory<u64>(address);
+    }
+    void WriteMemory8(u32 address, u8 data) {
+        WriteMemory<u8>(address, data);
+    }
+    void WriteMemory16(u32 address, u16 data) {
+        WriteMemory<u16>(address, data);
+    }
+    void WriteMemory32(u32 address, u32 data) {
+        WriteMemory<u32>(address, data);
+    }
+    void WriteMemory64(u32 address, u64 data) {
+        WriteMemory<u64>(address, data);
+    }
 
     u32 ReadCP15Register(u32 crn, u32 opcode_1, u32 crm, u32 opcode_2) const;
     void WriteCP15Register(u32 value, u32 crn, u32 opcode_1, u32 crm, u32 opcode_2);
@@ -180,6 +200,41 @@ public:
         exclusive_state = false;
     }
 
+    // Exclusive loads remember the value they read, and exclusive stores to plain memory only
+    // succeed if it is still there. This keeps LDREX/STREX pairs atomic with respect to cores
+    // running on other host threads.
+    template <typename T>
+    T ReadMemoryExclusive(u32 address) {
+        SetExclusiveMemoryAddress(address);
+        const T data = ReadMemory<T>(address);
+        exclusive_value = InBigEndianMode() ? SwapBytes(data) : data;
+        return data;
+    }
+    template <typename T>
+    bool WriteMemoryExclusive(u32 address, T data) {
+        if (!IsExclusiveMemoryAccess(address)) {
+            return false;
+        }
+        UnsetExclusiveMemoryAddress();
+
+        if (check_memory_breakpoints) [[unlikely]] {
+            CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Write);
+        }
+
+        if (InBigEndianMode())
+            data = SwapBytes(data);
+
+        u8* page_pointer =
+            page_pointers ? page_pointers[address >> Memory::CITRA_PAGE_BITS] : nullptr;
+        if (page_pointer && (address & (sizeof(T) - 1)) == 0) [[likely]] {
+            return Common::AtomicCompareAndSwap(
+                reinterpret_cast<volatile T*>(page_pointer + (address & Memory::CITRA_PAGE_MASK)),
+                data, static_cast<T>(exclusive_value));
+        }
+        WriteMemorySlow<T>(address, data);
+        return true;
+    }
+
     // Whether or not the given CPU is in big endian mode (E bit is set)
     bool InBigEndianMode() const {
         return (Cpsr & (1 << 9)) != 0;
@@ -199,6 +254,32 @@ public:
         return TFlag ? 2 : 4;
     }
 
+    // Defers computing NZCV for the addition left + right + carry_in until a flag is read.
+    // Subtractions are recorded as additions of the inverted operand.
+    void SetPendingFlags(u32 left, u32 right, u32 carry_in) {
+        flags_left = left;
+        flags_right = right;
+        flags_carry_in = carry_in;
+        flags_pending = true;
+    }
+    // Computes the flags of a deferred addition. Must be called before any flag is accessed.
+    void ResolveFlags() {
+        if (!flags_pending) {
+            return;
+        }
+        const u64 sum = static_cast<u64>(flags_left) + flags_right + flags_carry_in;
+        const u32 result = static_cast<u32>(sum);
+        NFlag = result >> 31;
+        ZFlag = result == 0;
+        CFlag = static_cast<u32>(sum >> 32);
+        VFlag = ((flags_left ^ result) & (flags_right ^ result)) >> 31;
+        flags_pending = false;
+    }
+    u32 CarryFlag() {
+        ResolveFlags();
+        return CFlag;
+    }
+
     void RecordBreak(GDBStub::BreakpointAddress bkpt) {
         last_bkpt = bkpt;
         last_bkpt_hit = true;
@@ -238,6 +319,10 @@ public:
     u32 NFlag, ZFlag, CFlag, VFlag, IFFlags; // Dummy flags for speed
     unsigned int shifter_carry_out;
 
+    // Operands of the last flag-setting addition whose NZCV has not been computed yet
+    bool flags_pending = false;
+    u32 flags_left, flags_right, flags_carry_in;
+
     u32 TFlag; // Thumb state
 
     unsigned long long NumInstrs; // The number of instructions executed
@@ -254,11 +339,82 @@ public:
 
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
-    std::unordered_map<u32, std::size_t> instruction_cache;
+    TranslationCache instruction_cache;
+
+    // Page pointers of the page table of this core, or nullptr to go through MemorySystem for
+    // every access. Pages without a pointer always take the MemorySystem path.
+    u8** page_pointers = nullptr;
+
+    // Whether memory accesses are checked against GDB breakpoints. Only set while a debugger is
+    // connected, so that the check costs a single branch otherwise.
+    bool check_memory_breakpoints = false;
+
+    // Set by the interpreter when it stops at the end of an idle loop.
+    bool reached_idle_loop = false;
+
+    // Id of the core this state belongs to, used to enter the state shared by all cores.
+    u32 core_id = 0;
 
 private:
     void ResetMPCoreCP15Registers();
 
+    template <typename T>
+    static T SwapBytes(T data) {
+        if constexpr (sizeof(T) == 2) {
+            return Common::swap16(data);
+        } else if constexpr (sizeof(T) == 4) {
+            return Common::swap32(data);
+        } else if constexpr (sizeof(T) == 8) {
+            return Common::swap64(data);
+        } else {
+            return data;
+        }
+    }
+
+    template <typename T>
+    T ReadMemory(u32 address) const {
+        if (check_memory_breakpoints) [[unlikely]] {
+            CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Read);
+        }
+
+        T data;
+        const u8* page_pointer =
+            page_pointers ? page_pointers[address >> Memory::CITRA_PAGE_BITS] : nullptr;
+        if (page_pointer) [[likely]] {
+            std::memcpy(&data, page_pointer + (address & Memory::CITRA_PAGE_MASK), sizeof(T));
+        } else {
+            data = ReadMemorySlow<T>(address);
+        }
+
+        return InBigEndianMode() ? SwapBytes(data) : data;
+    }
+
+    template <typename T>
+    void WriteMemory(u32 address, T data) {
+        if (check_memory_breakpoints) [[unlikely]] {
+            CheckMemoryBreakpoint(address, GDBStub::BreakpointType::Write);
+        }
+
+        if (InBigEndianMode())
+            data = SwapBytes(data);
+
+        u8* page_pointer =
+            page_pointers ? page_pointers[address >> Memory::CITRA_PAGE_BITS] : nullptr;
+        if (page_pointer) [[likely]] {
+            std::memcpy(page_pointer + (address & Memory::CITRA_PAGE_MASK), &data, sizeof(T));
+        } else {
+            WriteMemorySlow<T>(address, data);
+        }
+    }
+
+    // Accesses which are not to plain memory (MMIO, rasterizer cached and unmapped pages)
+    template <typename T>
+    T ReadMemorySlow(u32 address) const;
+    template <typename T>
+    void WriteMemorySlow(u32 address, T data);
+
+    void CheckMemoryBreakpoint(u32 address, GDBStub::BreakpointType type) const;
+
     // Defines a reservation granule of 2 words, which protects the first 2 words starting at the
     // tag. This is the smallest granule allowed by the v7 spec, and is coincidentally just large
     // enough to support LDR/STREXD.
@@ -266,6 +422,7 @@ private:
 
     u32 exclusive_tag; // The address for which the local monitor is in exclusive access mode
     bool exclusive_state;
+    u64 exclusive_value = 0; // Memory contents read by the last exclusive load, in memory order
 
     GDBStub::BreakpointAddress last_bkpt{};
     bool last_bkpt_hit = false;
@@ -1098,6 +1098,7 @@ VMRS_INST : {
             if (rt != 15) {
                 cpu->Reg[rt] = cpu->VFP[VFP_FPSCR];
             } else {
+                cpu->flags_pending = false;
                 cpu->NFlag = (cpu->VFP[VFP_FPSCR] >> 31) & 1;
                 cpu->ZFlag = (cpu->VFP[VFP_FPSCR] >> 30) & 1;
                 cpu->CFlag = (cpu->VFP[VFP_FPSCR] >> 29) & 1;
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <memory>
 #include <mutex>
+#include <span>
 #include <string>
 #include <boost/optional.hpp>
 #include <boost/serialization/version.hpp>
@@ -19,6 +20,11 @@
 #include "core/movie.h"
 #include "core/perf_stats.h"
 
+namespace Common {
+template <class StateType>
+class StatefulThreadWorker;
+} // namespace Common
+
 namespace Frontend {
 class EmuWindow;
 class ImageInterface;
@@ -28,6 +34,7 @@ class SoftwareKeyboard;
 
 namespace Memory {
 class MemorySystem;
+struct RamStorage;
 }
 
 namespace AudioCore {
@@ -74,6 +81,7 @@ namespace Core {
 
 class ARM_Interface;
 class ExclusiveMonitor;
+class RewindBuffer;
 class Timing;
 
 class System {
@@ -120,6 +128,14 @@ public:
      */
     [[nodiscard]] ResultStatus RunLoop(bool tight_loop = true);
 
+    /**
+     * Runs the core until the next VBlank has been emulated, so that frontends driving the
+     * emulation one frame at a time get exactly one new frame per call. The amount of emulated
+     * time is bounded, in case the guest never reaches a VBlank.
+     * @return Result status, indicating whethor or not the operation succeeded.
+     */
+    [[nodiscard]] ResultStatus RunFrame();
+
     /**
      * Step the CPU one instruction
      * @return Result status, indicating whethor or not the operation succeeded.
@@ -220,6 +236,19 @@ public:
         }
     }
 
+    /**
+     * Makes the given core the running core for as long as the returned lock is held, so that it
+     * may access the kernel, timing and memory state shared by all cores. This only locks while
+     * the cores run on their own host threads, and returns an empty lock otherwise.
+     * @param core_id The id of the core entering the shared state.
+     */
+    [[nodiscard]] std::unique_lock<std::recursive_mutex> LockCoreContext(u32 core_id);
+
+    /// Returns whether the given core may be executing on another host thread right now.
+    [[nodiscard]] bool IsCoreRunningConcurrently(const ARM_Interface& core) const {
+        return cores_running_in_parallel && running_core != &core;
+    }
+
     /**
      * Gets a reference to the emulated DSP.
      * @returns A reference to the emulated DSP.
@@ -287,6 +316,9 @@ public:
     /// Gets a const reference to the movie recorder
     [[nodiscard]] const Core::Movie& Movie() const;
 
+    /// Gets a reference to the in-memory rewind buffer
+    [[nodiscard]] Core::RewindBuffer& RewindBuffer();
+
     /// Video Dumper interface
 
     void RegisterVideoDumper(std::shared_ptr<VideoDumper::Backend> video_dumper);
@@ -360,6 +392,24 @@ public:
 
     void LoadState(u32 slot);
 
+    /**
+     * Takes over the contents of the emulated RAM when the system is serialized. It is called
+     * with VRAM, FCRAM and the N3DS extra RAM at the point where they would be serialized, to
+     * store them when saving or to fill them when loading, and they are left out of the archive.
+     * When loading, the system keeps its RAM across the reinitialization, so the regions still
+     * hold the RAM from before the load and the handler must overwrite all of it.
+     */
+    using RamStateHandler = std::function<void(std::span<const std::span<u8>> regions)>;
+
+    /// Sets the handler for the emulated RAM. An empty handler serializes the RAM again.
+    void SetRamStateHandler(RamStateHandler handler) {
+        ram_state_handler = std::move(handler);
+    }
+
+    [[nodiscard]] const RamStateHandler& GetRamStateHandler() const {
+        return ram_state_handler;
+    }
+
     /// Self delete ncch
     bool SetSelfDelete(const std::string& file) {
         if (m_filepath == file) {
@@ -393,6 +443,9 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Runs the slice of every core with a current thread, each core on its own host thread
+    void RunCoresInParallel(s64 max_slice, bool tight_loop);
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -403,6 +456,12 @@ private:
     std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
     ARM_Interface* running_core = nullptr;
 
+    /// Host threads running the slices of all cores but the first one, in parallel mode
+    std::unique_ptr<Common::StatefulThreadWorker<void>> core_workers;
+    /// Held by a core while it accesses state shared by all cores, in parallel mode
+    std::recursive_mutex core_context_mutex;
+    bool cores_running_in_parallel = false;
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -421,6 +480,12 @@ private:
     /// Movie recorder
     Core::Movie movie;
 
+    /// In-memory savestates for rewinding
+    std::unique_ptr<Core::RewindBuffer> rewind_buffer;
+    RamStateHandler ram_state_handler;
+    /// RAM of the memory system that was shut down to load a state through the RAM handler
+    std::unique_ptr<Memory::RamStorage> kept_ram;
+
     /// Cheats manager
     Cheats::CheatEngine cheat_engine;
 
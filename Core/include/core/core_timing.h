@@ -17,11 +17,15 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <limits>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/vector.hpp>
@@ -137,6 +141,14 @@ using TimedCallback = std::function<void(std::uintptr_t user_data, int cycles_la
 struct TimingEventType {
     TimedCallback callback;
     const std::string* name;
+
+    // Bookkeeping of the timers, which reach the type through the const pointers of its events
+    /// Number of events of this type in the event queues, not counting the thread safe queues
+    mutable u32 num_pending = 0;
+    /// Number of times the callback has run
+    mutable u64 num_fired = 0;
+    /// Host time spent in the callback
+    mutable std::chrono::nanoseconds host_time{};
 };
 
 class Timing {
@@ -175,6 +187,89 @@ public:
         BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 
+    /**
+     * Scheduled events of a timer, as a binary min-heap in the order of Event. The events with
+     * the same type and user data are linked together, so that they can be unscheduled in
+     * O(log n) without searching the heap.
+     */
+    class EventQueue {
+    public:
+        [[nodiscard]] bool Empty() const {
+            return heap.empty();
+        }
+
+        [[nodiscard]] std::size_t Size() const {
+            return heap.size();
+        }
+
+        /// Returns the earliest event. The queue must not be empty.
+        [[nodiscard]] const Event& Front() const {
+            return slots[heap.front().slot].event;
+        }
+
+        void Push(const Event& event);
+
+        /// Removes and returns the earliest event. The queue must not be empty.
+        Event Pop();
+
+        /// Removes the events with the given type and user data.
+        void Remove(const TimingEventType* type, std::uintptr_t user_data);
+
+        /// Removes the events with the given type, regardless of their user data.
+        void RemoveType(const TimingEventType* type);
+
+        /// Returns the events in heap order, which is the layout the queue is serialized with.
+        [[nodiscard]] std::vector<Event> GetEvents() const;
+
+        /// Replaces the contents of the queue with the given events.
+        void SetEvents(const std::vector<Event>& events);
+
+        /// Returns the time of the latest event which is due no later than the given time.
+        /// The earliest event must be due no later than that.
+        [[nodiscard]] s64 GetLatestTimeUntil(s64 limit) const;
+
+    private:
+        static constexpr u32 INVALID_SLOT = std::numeric_limits<u32>::max();
+
+        struct HeapEntry {
+            s64 time;
+            u64 fifo_order;
+            u32 slot;
+
+            bool operator<(const HeapEntry& right) const {
+                return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
+            }
+        };
+
+        struct Slot {
+            Event event;
+            u32 heap_index;
+            /// Neighbours in the list of events with the same type and user data
+            u32 prev_same_key;
+            u32 next_same_key;
+        };
+
+        using Key = std::pair<const TimingEventType*, std::uintptr_t>;
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const {
+                return std::hash<const void*>{}(key.first) ^ (key.second * 0x9E3779B97F4A7C15ull);
+            }
+        };
+
+        void Place(std::size_t index, const HeapEntry& entry);
+        void SiftUp(std::size_t index);
+        void SiftDown(std::size_t index);
+        void RemoveFromHeap(u32 slot);
+        void UnlinkFromKey(u32 slot);
+        s64 GetLatestTimeUntil(std::size_t index, s64 limit) const;
+
+        std::vector<HeapEntry> heap;
+        std::vector<Slot> slots;
+        std::vector<u32> free_slots;
+        /// Most recently pushed event of each type and user data
+        std::unordered_map<Key, u32, KeyHash> latest_by_key;
+    };
+
     // currently Service::HID::pad_update_ticks is the smallest interval for an event that gets
     // always scheduled. Therfore we use this as orientation for the MAX_SLICE_LENGTH
     // For performance bigger slice length are desired, though this will lead to cores desync
@@ -183,12 +278,22 @@ public:
     // scheduled and repated.
     static constexpr int MAX_SLICE_LENGTH = BASE_CLOCK_RATE_ARM11 / 234;
 
+    // Slices may be longer while no thread waits for a timeout. Events from other host threads
+    // are scheduled at least 2 * MAX_SLICE_LENGTH ahead, so such a slice still never passes them.
+    static constexpr int LONG_SLICE_LENGTH = MAX_SLICE_LENGTH * 2;
+
+    struct EventStats {
+        std::string_view name;
+        u64 num_fired;
+        std::chrono::nanoseconds host_time;
+    };
+
     class Timer {
     public:
         Timer(s64 base_ticks = 0);
         ~Timer();
 
-        s64 GetMaxSliceLength() const;
+        s64 GetMaxSliceLength(s64 limit = MAX_SLICE_LENGTH) const;
 
         void Advance();
 
@@ -209,15 +314,32 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accommodated by the standard adaptor class.
-        std::vector<Event> event_queue;
+
+        /// Returns the time the next slice should end at to handle the next events.
+        s64 GetNextEventBoundary() const;
+
+        /// Drops the events of the given type and user data which are still in ts_queue.
+        void CancelQueuedEvents(const TimingEventType* type, std::uintptr_t user_data,
+                                bool any_user_data);
+
+        EventQueue event_queue;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
-        // to the event_queue by the emu thread
+        // to the event_queue by the emu thread. Until then, the fifo_order of these events holds
+        // the order they were pushed in.
         Common::MPSCQueue<Event> ts_queue;
+        std::atomic<u64> ts_pushed = 0;
+        u64 ts_moved = 0;
+
+        /// Events unscheduled while they may still be in ts_queue. The events pushed before the
+        /// cancellation are dropped once they leave the queue.
+        struct Cancellation {
+            const TimingEventType* type;
+            std::uintptr_t user_data;
+            bool any_user_data;
+            u64 pushed_before;
+        };
+        std::vector<Cancellation> ts_cancellations;
         // Are we in a function that has been called from Advance()
         // If events are sheduled from a function that gets called from Advance(),
         // don't change slice_length and downcount.
@@ -236,10 +358,22 @@ public:
         // under/overclocking the guest cpu
         double cpu_clock_scale = 1.0;
 
+        // Events due within this many ticks of the next event are handled with it, instead of
+        // ending a slice of their own.
+        s64 coalescing_window = 0;
+
         template <class Archive>
         void serialize(Archive& ar, const unsigned int) {
             MoveEvents();
-            ar & event_queue;
+            // Stored as the vector heap the queue used to be, so older states stay loadable.
+            if constexpr (Archive::is_loading::value) {
+                std::vector<Event> events;
+                ar & events;
+                event_queue.SetEvents(events);
+            } else {
+                std::vector<Event> events = event_queue.GetEvents();
+                ar & events;
+            }
             ar & event_fifo_id;
             ar & slice_length;
             ar & downcount;
@@ -285,6 +419,9 @@ public:
 
     std::shared_ptr<Timer> GetTimer(std::size_t cpu_id);
 
+    /// Returns how often the callback of each event type has run and the host time it took.
+    [[nodiscard]] std::vector<EventStats> GetEventStats() const;
+
     // Used after deserializing to unprotect the event queue.
     void UnlockEventQueue() {
         event_queue_locked = false;
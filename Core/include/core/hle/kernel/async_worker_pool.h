@@ -0,0 +1,110 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+
+namespace Kernel {
+
+/// Selects where the async section of an HLE request started with RunAsync is executed.
+enum class AsyncLane : u8 {
+    /// Short I/O requests. They are served before large ones so they don't wait behind them.
+    Small,
+    /// Bulk I/O requests, such as large file reads and writes.
+    Large,
+    /**
+     * A host thread of its own, outside of the worker pool. Used for requests that may block
+     * for an unbounded time (socket and network waits), which would otherwise starve the pool.
+     */
+    Dedicated,
+};
+
+struct AsyncHint {
+    AsyncLane lane = AsyncLane::Dedicated;
+    /// Pooled requests with the same non-zero key run one at a time, in the order they were queued.
+    u64 order_key = 0;
+};
+
+/**
+ * Bounded pool of named host threads running the async sections of HLE requests. Requests are
+ * queued in a lane, and requests sharing an order key (for example all operations on one
+ * archive) are held back until the previous one with that key has finished.
+ */
+class AsyncWorkerPool {
+public:
+    static constexpr std::size_t NUM_LANES = 2;
+
+    struct LaneStats {
+        std::size_t queue_depth;      ///< Requests waiting for a worker
+        std::size_t peak_queue_depth; ///< Largest queue depth seen so far
+        u64 completed;                ///< Requests that have finished running
+        u64 total_wait_ns;            ///< Time requests spent queued, including ordering waits
+        u64 max_wait_ns;              ///< Longest time a request spent queued
+        u64 total_run_ns;             ///< Time spent running requests
+        u64 max_run_ns;               ///< Longest time spent running a request
+    };
+
+    struct Stats {
+        std::size_t num_workers;
+        std::size_t num_held; ///< Requests waiting for an earlier request with the same key
+        std::array<LaneStats, NUM_LANES> lanes;
+    };
+
+    explicit AsyncWorkerPool(std::size_t num_workers);
+    ~AsyncWorkerPool();
+
+    AsyncWorkerPool(const AsyncWorkerPool&) = delete;
+    AsyncWorkerPool& operator=(const AsyncWorkerPool&) = delete;
+
+    /**
+     * Queues work on the lane and with the order key of the hint. Work still queued when the
+     * pool is destroyed is discarded without running.
+     */
+    void QueueWork(const AsyncHint& hint, Common::UniqueFunction<void> work);
+
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        Common::UniqueFunction<void> work;
+        Clock::time_point queued_at;
+        u64 order_key;
+        u32 lane;
+    };
+
+    void WorkerLoop(std::stop_token stop_token);
+
+    /// Takes the next request to run. Must be called with the mutex held and a lane non-empty.
+    Request PopRequest();
+
+    /// Queues a request in its lane. Must be called with the mutex held.
+    void Enqueue(Request request);
+
+    mutable std::mutex mutex;
+    std::condition_variable_any condition;
+    std::array<std::deque<Request>, NUM_LANES> lanes;
+    /// Order keys of the queued or running requests, with the requests held back behind them.
+    std::unordered_map<u64, std::deque<Request>> held;
+    std::size_t num_held = 0;
+    /// Small requests taken in a row while large requests were waiting.
+    u32 small_streak = 0;
+    std::array<LaneStats, NUM_LANES> stats{};
+    std::vector<std::jthread> threads;
+};
+
+} // namespace Kernel
@@ -18,8 +18,10 @@
 #include "common/settings.h"
 #include "common/swap.h"
 #include "core/hle/ipc.h"
+#include "core/hle/kernel/async_worker_pool.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/memory.h"
 
 namespace Service {
 class ServiceFrameworkBase;
@@ -127,6 +129,17 @@ public:
     // interface for service
     void Read(void* dest_buffer, std::size_t offset, std::size_t size);
     void Write(const void* src_buffer, std::size_t offset, std::size_t size);
+
+    /**
+     * Gets the guest memory of a range of the buffer as host memory spans, so that services can
+     * transfer data to and from it without a temporary copy. Returns no spans if the range can
+     * not be accessed directly, in which case Read and Write must be used. The access is R when
+     * the service reads the spans and W when it writes them. The spans must only be used from
+     * the emulator thread before the guest runs again.
+     */
+    Memory::BlockSpans GetSpans(std::size_t offset, std::size_t size,
+                                IPC::MappedBufferPermissions access);
+
     std::size_t GetSize() const {
         return size;
     }
@@ -267,6 +280,13 @@ private:
             future = std::move(fut);
         }
 
+        ~AsyncWakeUpCallback() override {
+            // Pooled work does not block in the destructor of its future like std::async does.
+            if (future.valid()) {
+                future.wait();
+            }
+        }
+
         void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
                     Kernel::ThreadWakeupReason reason) override {
             functor(ctx);
@@ -297,21 +317,31 @@ public:
      * and can be used to set the IPC result.
      * @param really_async If set to false, it will call both async_section and result_function
      * from the emulator thread.
+     * @param hint Lane and order key of the async section. By default it runs on a host thread of
+     * its own, I/O requests should instead be queued in the worker pool.
      */
     template <typename AsyncFunctor, typename ResultFunctor>
     void RunAsync(AsyncFunctor async_section, ResultFunctor result_function,
-                  bool really_async = true) {
+                  bool really_async = true, const AsyncHint& hint = {}) {
 
         if (!Settings::values.deterministic_async_operations && really_async) {
             kernel.ReportAsyncState(true);
-            this->SleepClientThread(
-                "RunAsync", std::chrono::nanoseconds(-1),
-                std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
-                    kernel, result_function,
-                    std::move(std::async(std::launch::async, [this, async_section] {
-                        s64 sleep_for = async_section(*this);
-                        this->thread->WakeAfterDelay(sleep_for, true);
-                    }))));
+            auto run_section = [this, async_section] {
+                s64 sleep_for = async_section(*this);
+                this->thread->WakeAfterDelay(sleep_for, true);
+            };
+            std::future<void> future;
+            if (hint.lane == AsyncLane::Dedicated) {
+                future = std::async(std::launch::async, std::move(run_section));
+            } else {
+                std::packaged_task<void()> task{std::move(run_section)};
+                future = task.get_future();
+                kernel.GetAsyncWorkerPool().QueueWork(
+                    hint, [task = std::move(task)]() mutable { task(); });
+            }
+            this->SleepClientThread("RunAsync", std::chrono::nanoseconds(-1),
+                                    std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
+                                        kernel, result_function, std::move(future)));
 
         } else {
             s64 sleep_for = async_section(*this);
@@ -47,6 +47,7 @@ class Recorder;
 namespace Kernel {
 
 class AddressArbiter;
+class AsyncWorkerPool;
 class Event;
 class Mutex;
 class CodeSet;
@@ -306,6 +307,10 @@ public:
     IPCDebugger::Recorder& GetIPCRecorder();
     const IPCDebugger::Recorder& GetIPCRecorder() const;
 
+    /// Returns the worker pool running the async sections of HLE requests.
+    AsyncWorkerPool& GetAsyncWorkerPool();
+    const AsyncWorkerPool& GetAsyncWorkerPool() const;
+
     std::shared_ptr<MemoryRegionInfo> GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -376,6 +381,10 @@ private:
     std::atomic<int> pending_async_operations{};
 
     // Note: keep the member order below in order to perform correct destruction.
+    // The async worker pool is destructed after the thread managers and process list, as threads
+    // waiting on an async HLE request wait for its pooled work to finish when they are destructed.
+    std::unique_ptr<AsyncWorkerPool> async_worker_pool;
+
     // Thread manager is destructed before process list in order to Stop threads and clear thread
     // info from their parent processes first. Timer manager is destructed after process list
     // because timers are destructed along with process list and they need to clear info from the
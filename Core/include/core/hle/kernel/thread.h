@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <span>
 #include <string>
@@ -58,11 +59,16 @@ enum class ThreadStatus {
     Dead          ///< Run to completion, or forcefully terminated
 };
 
+constexpr std::size_t NUM_THREAD_STATUSES = static_cast<std::size_t>(ThreadStatus::Dead) + 1;
+
 enum class ThreadWakeupReason {
     Signal, // The thread was woken up by WakeupAllWaitingThreads due to an object signal.
     Timeout // The thread was woken up due to a wait timeout.
 };
 
+constexpr std::size_t NUM_THREAD_WAKEUP_REASONS =
+    static_cast<std::size_t>(ThreadWakeupReason::Timeout) + 1;
+
 class Thread;
 
 class WakeupCallback {
@@ -106,6 +112,11 @@ public:
      */
     bool HaveReadyThreads();
 
+    /**
+     * Returns whether any thread waits with a timeout that is scheduled on the core timer.
+     */
+    bool HasPendingWakeups() const;
+
     /**
      * Waits the current thread on a sleep
      */
@@ -151,7 +162,7 @@ private:
     void ThreadWakeupCallback(u64 thread_id, s64 cycles_late);
 
     Kernel::KernelSystem& kernel;
-    Core::ARM_Interface* cpu;
+    Core::ARM_Interface* cpu = nullptr;
 
     std::shared_ptr<Thread> current_thread;
     Common::ThreadQueueList<Thread*, ThreadPrioLowest + 1> ready_queue;
@@ -174,6 +185,16 @@ private:
 
 class Thread final : public WaitObject {
 public:
+    /// Scheduler statistics of a thread. These are for profiling only, and are not saved.
+    struct Stats {
+        u64 context_switches; ///< Number of times the thread was switched to
+        /// Emulated ticks spent in each ThreadStatus
+        std::array<u64, NUM_THREAD_STATUSES> status_ticks;
+        u64 resumes; ///< Number of times the thread was resumed from waiting
+        /// Number of object signals and timeouts which woke the thread, by ThreadWakeupReason
+        std::array<u64, NUM_THREAD_WAKEUP_REASONS> wakeups;
+    };
+
     explicit Thread(KernelSystem&, u32 core_id);
     ~Thread() override;
 
@@ -290,6 +311,20 @@ public:
         return status == ThreadStatus::WaitSynchAll;
     }
 
+    /**
+     * Changes the status of the thread, accounting the time spent in the previous status
+     * @param new_status The status to change to
+     */
+    void SetStatus(ThreadStatus new_status);
+
+    /// Counts a wakeup of the thread by an object signal or a timeout
+    void CountWakeup(ThreadWakeupReason reason) {
+        stats.wakeups[static_cast<std::size_t>(reason)]++;
+    }
+
+    /// Returns the scheduler statistics of the thread, including the time in its current status
+    Stats GetStats() const;
+
     Core::ARM_Interface::ThreadContext context{};
 
     u32 thread_id;
@@ -332,8 +367,13 @@ public:
     const u32 core_id;
 
 private:
+    u64 GetCurrentTicks() const;
+
     ThreadManager& thread_manager;
 
+    Stats stats{};
+    u64 status_start_ticks = 0; ///< CPU tick when the thread entered its current status
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int);
@@ -57,6 +57,9 @@ public:
     void SetHLENotifier(std::function<void()> callback);
 
 private:
+    /// Returns whether the waiting thread can be woken, as it may acquire all its objects.
+    bool IsReadyToRun(const Thread* thread) const;
+
     /// Threads waiting for this object to become available
     std::vector<std::shared_ptr<Thread>> waiting_threads;
 
@@ -73,6 +73,10 @@ private:
     void OpenLinkFile(Kernel::HLERequestContext& ctx);
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
+    /// Returns the async hint of an operation transferring length bytes, ordered with the
+    /// other operations on this file.
+    Kernel::AsyncHint GetAsyncHint(std::size_t length) const;
+
     Kernel::KernelSystem& kernel;
 
     File(Kernel::KernelSystem& kernel);
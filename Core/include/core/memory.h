@@ -5,7 +5,10 @@
 #pragma once
 #include <array>
 #include <cstddef>
+#include <memory>
+#include <span>
 #include <string>
+#include <boost/container/small_vector.hpp>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/vector.hpp>
 #include "common/common_types.h"
@@ -235,11 +238,28 @@ enum class FlushMode {
     FlushAndInvalidate,
 };
 
+/// Host memory backing a block of virtual memory, one span per run of host-contiguous pages.
+using BlockSpans = boost::container::small_vector<std::span<u8>, 4>;
+
+/// Host memory backing the emulated RAM.
+struct RamStorage {
+    std::unique_ptr<u8[]> fcram;
+    std::unique_ptr<u8[]> vram;
+    std::unique_ptr<u8[]> n3ds_extra_ram;
+};
+
 class MemorySystem {
 public:
-    explicit MemorySystem(Core::System& system);
+    /**
+     * @param ram RAM taken from a previous memory system with ReleaseRam, which is used with its
+     *            contents as they are. New, cleared RAM is allocated if it is empty.
+     */
+    explicit MemorySystem(Core::System& system, RamStorage ram = {});
     ~MemorySystem();
 
+    /// Takes the RAM out of the memory system, which must not be used afterwards.
+    [[nodiscard]] RamStorage ReleaseRam();
+
     /**
      * Maps an allocated buffer onto a region of the emulated process address space.
      *
@@ -598,6 +618,21 @@ public:
     void CopyBlock(const Kernel::Process& dest_process, const Kernel::Process& src_process,
                    VAddr dest_addr, VAddr src_addr, std::size_t size);
 
+    /**
+     * Gets the host memory backing a block of a given process' address space, so that it can
+     * be accessed without an intermediate buffer. Pages that are adjacent in host memory are
+     * merged into one span.
+     *
+     * @param process The process whose address space the block is in.
+     * @param addr    The virtual address of the block.
+     * @param size    The size of the block, in bytes.
+     *
+     * @returns The spans covering the block in order, or no spans if any page of the block is
+     *          unmapped or cached by the rasterizer. ReadBlock and WriteBlock must be used for
+     *          such blocks instead.
+     */
+    BlockSpans GetBlockSpans(const Kernel::Process& process, VAddr addr, std::size_t size);
+
     /**
      * Marks each page within the specified address range as cached or uncached.
      *
@@ -611,9 +646,20 @@ public:
     /// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
     std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr);
 
-    /// Gets a pointer to the memory region beginning at the specified physical address.
+    /**
+     * Gets a pointer to the memory region beginning at the specified physical address.
+     * Unlike GetPhysicalRef this does not use the lookup cache, so it is safe to call from
+     * renderer worker threads.
+     */
     u8* GetPhysicalPointer(PAddr address);
 
+    /**
+     * Gets the memory from the specified physical address to the end of its region, or an empty
+     * span if the address is invalid. Like GetPhysicalPointer, it is safe to call from renderer
+     * worker threads.
+     */
+    std::span<u8> GetPhysicalSpan(PAddr address);
+
     /// Returns a reference to the memory region beginning at the specified physical address
     MemoryRef GetPhysicalRef(PAddr address);
 
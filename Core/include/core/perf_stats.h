@@ -9,6 +9,7 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <optional>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/thread.h"
@@ -65,8 +66,15 @@ public:
         // Walltime in seconds of the vblank interval spent in Renderer::SwapBuffers (includes
         // waiting for host GPU to finish)
         double time_swap;
+        // Walltime in seconds of the vblank interval spent executing guest code, excluding SVCs
+        double time_cpu;
+        // Walltime in seconds of the vblank interval spent in DSP emulation
+        double time_dsp;
         // Walltime in seconds of the vblank interval spent in other operations
         double time_remaining;
+        // Walltime in seconds of the vblank interval spent outside of emulation: frame limiting,
+        // and when the frontend drives emulation with RunFrame, the time between RunFrame calls
+        double time_idle;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
         /// Artic base bytes per second
@@ -81,11 +89,17 @@ public:
     void EndIPCProcessing();
     void BeginGPUProcessing();
     void EndGPUProcessing();
+    void BeginCPUProcessing();
+    void EndCPUProcessing();
+    void BeginDSPProcessing();
+    void EndDSPProcessing();
     void StartSwap();
     void EndSwap();
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
+    void BeginRunFrame();
+    void EndRunFrame();
 
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
@@ -171,6 +185,20 @@ private:
     Clock::time_point start_swap_time = reset_point;
     Clock::duration accumulated_swap_time = Clock::duration::zero();
 
+    Clock::time_point start_cpu_time = reset_point;
+    Clock::duration accumulated_cpu_time = Clock::duration::zero();
+
+    Clock::time_point start_dsp_time = reset_point;
+    Clock::duration accumulated_dsp_time = Clock::duration::zero();
+
+    /// Cumulative walltime spent between system frames since last reset
+    Clock::duration accumulated_idle_time = Clock::duration::zero();
+
+    /// Point when the last RunFrame call returned, if the frontend has not called it again yet
+    std::optional<Clock::time_point> run_frame_end;
+    /// Cumulative walltime spent in the frontend between RunFrame calls since last reset
+    Clock::duration accumulated_frontend_time = Clock::duration::zero();
+
     /// Last recorded performance statistics.
     Results last_stats;
 };
@@ -0,0 +1,148 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <span>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+class System;
+
+/**
+ * In-memory ring of savestates for rewinding. The emulated RAM is tracked in pages: a keyframe
+ * stores every page that is not all zeroes, and the states captured after it only store the
+ * pages whose hash differs from the keyframe. The rest of the system state is stored in full
+ * with each state, as it is small compared to the RAM. Once the states take more memory than
+ * the budget set by the rewind_buffer_size setting, the oldest keyframe is dropped together
+ * with the states that depend on it.
+ *
+ * Guest writes to the RAM are not tracked, so capturing a state hashes every page. Restoring a
+ * state hashes every page as well, but only decompresses and writes the pages that differ from
+ * the state, which are few when restoring a recent state as runahead does.
+ */
+class RewindBuffer {
+public:
+    static constexpr std::size_t PAGE_SIZE = 0x1000;
+
+    struct Stats {
+        std::size_t budget;        ///< Maximum number of bytes the states may take
+        std::size_t used_bytes;    ///< Bytes taken by the stored states
+        std::size_t num_states;    ///< Number of stored states
+        std::size_t num_keyframes; ///< Number of stored states that are keyframes
+        std::size_t last_pages;    ///< Pages stored by the last captured state
+        std::size_t last_bytes;    ///< Bytes taken by the last captured state
+        u64 captured;              ///< States captured so far
+        u64 evicted;               ///< States dropped to stay within the budget
+    };
+
+    explicit RewindBuffer(System& system);
+    ~RewindBuffer();
+
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+    /// Returns whether the rewind_buffer_size setting allows capturing states.
+    [[nodiscard]] bool IsEnabled() const;
+
+    /**
+     * Captures the current state of the system.
+     * @returns An identifier of the state, unique for the lifetime of the buffer, to pass to
+     *          Restore.
+     */
+    u64 Capture();
+
+    /**
+     * Loads a stored state into the system. The states captured after it are kept.
+     * @returns Whether the state was still stored.
+     */
+    bool Restore(u64 id);
+
+    /// Returns whether the state with the given identifier is still stored.
+    [[nodiscard]] bool Contains(u64 id) const;
+
+    /// Drops all stored states.
+    void Clear();
+
+    /**
+     * Drops the oldest states until the rest fit within the rewind_buffer_size setting, or all
+     * of them if the setting disables the buffer. Called when the setting changes.
+     */
+    void ApplyBudget();
+
+    /**
+     * Saves the current state of the system as a standalone keyframe, which LoadStandalone can
+     * load in any session of the same build. Pages that are all zeroes are left out, and the
+     * result is compressed.
+     */
+    [[nodiscard]] std::vector<u8> SaveStandalone();
+
+    /// Loads a state saved with SaveStandalone into the system.
+    void LoadStandalone(std::span<const u8> data);
+
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    /// Number of RAM regions saved in savestates: VRAM, FCRAM and the N3DS extra RAM
+    static constexpr std::size_t NUM_REGIONS = 3;
+
+    struct State {
+        u64 id;
+        bool is_keyframe;
+        /// Size of each RAM region when the state was captured
+        std::array<u32, NUM_REGIONS> region_sizes;
+        /// Compressed savestate of the system without the contents of the RAM
+        std::vector<u8> system_data;
+        /// Indices of the stored pages, counting the pages of all regions in order
+        std::vector<u32> page_indices;
+        /// Compressed contents of the stored pages, in chunks of PAGES_PER_CHUNK pages
+        std::vector<std::vector<u8>> page_chunks;
+        /// Hash of every page for keyframes, and of the stored pages for deltas. Left out of
+        /// standalone states.
+        std::vector<u64> page_hashes;
+
+        std::size_t Size() const;
+
+        template <class Archive>
+        void serialize(Archive& ar, const unsigned int);
+    };
+
+    /**
+     * Saves the system into a state. Only pages that differ from the hashes of the base are
+     * stored, or all non-zero pages when there is no base.
+     */
+    State Save(const State* base);
+
+    /**
+     * Loads a state into the system. For deltas, the pages the delta does not store are taken
+     * from its keyframe.
+     */
+    void Load(const State& state, const State* keyframe);
+
+    /// Returns the stored state with the given identifier, or the end of the states.
+    std::deque<State>::const_iterator Find(u64 id) const;
+
+    /// Returns the keyframe a stored state was captured against.
+    const State& KeyframeOf(std::deque<State>::const_iterator state) const;
+
+    /// Drops the oldest keyframes and their deltas until the states fit within the budget.
+    void Evict(std::size_t budget);
+
+    System& system;
+    std::deque<State> states;
+    std::size_t used_bytes = 0;
+    u64 next_id = 1;
+
+    std::size_t last_pages = 0;
+    std::size_t last_bytes = 0;
+    u64 captured = 0;
+    u64 evicted = 0;
+};
+
+} // namespace Core
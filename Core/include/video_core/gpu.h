@@ -8,6 +8,7 @@
 #include <memory>
 #include <boost/serialization/access.hpp>
 
+#include "common/unique_function.h"
 #include "core/hle/service/gsp/gsp_interrupt.h"
 
 namespace Service::GSP {
@@ -35,6 +36,10 @@ namespace VideoCore {
 /// Measured on hardware to be 2240568 timer cycles or 4481136 ARM11 cycles
 constexpr u64 FRAME_TICKS = 4481136ull;
 
+/// Emulated latency after which work queued on the GPU thread is waited on and its interrupts
+/// are delivered to the guest.
+constexpr u64 GPU_SYNC_TICKS = FRAME_TICKS / 64;
+
 class GraphicsDebugger;
 class RendererBase;
 class RightEyeDisabler;
@@ -57,6 +62,9 @@ public:
     /// Notify rasterizer that any caches of the specified region should be invalidated
     void InvalidateRegion(PAddr addr, u32 size);
 
+    /// Notify rasterizer that any caches of the specified region should be flushed and invalidated
+    void FlushAndInvalidateRegion(PAddr addr, u32 size);
+
     /// Flushes and invalidates all memory in the rasterizer cache and removes any leftover state.
     void ClearAll(bool flush);
 
@@ -75,6 +83,9 @@ public:
     /// Writes the provided value to the GPU virtual address.
     void WriteReg(VAddr addr, u32 data);
 
+    /// Returns the number of VBlanks that have occurred since the GPU was created.
+    [[nodiscard]] u64 GetVBlankCount() const;
+
     /// Returns a mutable reference to the renderer.
     [[nodiscard]] VideoCore::RendererBase& Renderer();
 
@@ -97,6 +108,10 @@ public:
     void ReportLoadingProgramID(u64 program_ID);
 
 private:
+    void ExecuteCommand(const Service::GSP::Command& command);
+
+    void WriteInternalReg(u32 index, u32 data);
+
     void SubmitCmdList(u32 index);
 
     // Interrupt index must be 0 or 1 to signal the relative PSC interrupt.
@@ -106,6 +121,20 @@ private:
 
     void VBlankCallback(uintptr_t user_data, s64 cycles_late);
 
+    void SyncCallback(uintptr_t user_data, s64 cycles_late);
+
+    /// Queues work on the GPU thread and schedules the event that synchronizes with it.
+    void PushWork(Common::UniqueFunction<void>&& work);
+
+    /// Blocks until the GPU thread has finished all queued work.
+    void WaitGPUThread();
+
+    /// Waits for the GPU thread and delivers the interrupts raised by its work.
+    void SyncGPUThread();
+
+    /// Signals an interrupt, deferring it to the next sync point when called from the GPU thread.
+    void SignalInterrupt(Service::GSP::InterruptId id);
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const u32 file_version);
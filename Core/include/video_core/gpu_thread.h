@@ -0,0 +1,62 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <utility>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+
+namespace VideoCore {
+
+/**
+ * Executes GSP work on a dedicated host thread so that command list processing overlaps with
+ * CPU emulation. Every submission is assigned a monotonically increasing fence, which the
+ * emulation thread can wait on before it touches state owned by the GPU thread.
+ */
+class GPUThread {
+public:
+    using Work = Common::UniqueFunction<void>;
+
+    GPUThread();
+    ~GPUThread();
+
+    GPUThread(const GPUThread&) = delete;
+    GPUThread& operator=(const GPUThread&) = delete;
+
+    /// Queues work for the GPU thread and returns the fence that is signalled once it completes.
+    u64 Push(Work&& work);
+
+    /// Blocks until the work identified by the provided fence has completed.
+    void WaitFor(u64 fence);
+
+    /// Blocks until all submitted work has completed.
+    void WaitIdle() {
+        WaitFor(submitted_fence);
+    }
+
+    /// Returns true when all submitted work has completed.
+    [[nodiscard]] bool IsIdle() const {
+        return completed_fence.load(std::memory_order_acquire) == submitted_fence;
+    }
+
+private:
+    void ThreadLoop(std::stop_token stop_token);
+
+    std::mutex queue_mutex;
+    std::condition_variable_any work_cv;
+    std::condition_variable_any done_cv;
+    std::queue<std::pair<u64, Work>> work_queue;
+    u64 submitted_fence{};
+    std::atomic<u64> completed_fence{};
+    std::jthread thread;
+};
+
+} // namespace VideoCore
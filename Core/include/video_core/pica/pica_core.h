@@ -5,6 +5,7 @@
 #pragma once
 
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/hle/service/gsp/gsp_interrupt.h"
 #include "video_core/pica/dirty_regs.h"
 #include "video_core/pica/geometry_pipeline.h"
@@ -28,6 +29,7 @@ namespace Pica {
 
 class DebugContext;
 class ShaderEngine;
+class VertexLoader;
 
 class PicaCore {
 public:
@@ -53,6 +55,10 @@ private:
 
     void LoadVertices(bool is_indexed);
 
+    /// Loads and shades the vertices listed in shade_vertex_ids across the vertex workers,
+    /// writing the output of each one to the same position of vs_outputs.
+    void ShadeVerticesParallel(const VertexLoader& loader, PAddr base_address);
+
 public:
     union Regs {
         static constexpr std::size_t NUM_REGS = 0x732;
@@ -306,6 +312,19 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+
+    // Batches with at least this many vertices are shaded on the vertex workers
+    static constexpr u32 PARALLEL_VERTEX_THRESHOLD = 512;
+    std::size_t num_vs_threads;
+    std::unique_ptr<Common::ThreadWorker> vs_workers;
+    std::vector<u32> shade_vertex_ids;
+    std::vector<u32> index_slots;
+    std::vector<AttributeBuffer> vs_outputs;
+    // Post-transform cache for indexed batches, mapping each vertex id to its vs_outputs slot.
+    // Entries are only valid when their generation matches the current batch.
+    std::vector<u32> vertex_slots;
+    std::vector<u32> vertex_slot_generations;
+    u32 vertex_generation{};
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
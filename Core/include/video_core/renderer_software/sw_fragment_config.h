@@ -0,0 +1,53 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include "common/bit_field.h"
+#include "common/common_funcs.h"
+#include "video_core/pica/regs_internal.h"
+
+namespace SwRenderer {
+
+/// Fragment pipeline features that specialized pipelines resolve at compile time.
+enum class FragmentFeatures : u32 {
+    None = 0,
+    Lighting = 1 << 0,     ///< Fragment lighting is enabled.
+    AlphaTest = 1 << 1,    ///< The alpha test is enabled.
+    DepthStencil = 1 << 2, ///< The depth stencil unit can reject or write fragments.
+    ColorCopy = 1 << 3,    ///< The output merger is a plain store of the combiner output.
+};
+DECLARE_ENUM_FLAG_OPERATORS(FragmentFeatures);
+
+/// Number of feature combinations that have a specialized pipeline.
+constexpr u32 NUM_FRAGMENT_FEATURE_SETS = 1 << 4;
+
+/**
+ * PICA state that selects the fragment pipeline of a draw. It only contains the state that
+ * decides which per-pixel work can be skipped; everything else is still read from the registers.
+ */
+struct FragmentConfig {
+    explicit FragmentConfig(const Pica::RegsInternal& regs);
+
+    /// Returns the specialized feature set for this config, or std::nullopt if the config
+    /// needs the generic pipeline.
+    [[nodiscard]] std::optional<FragmentFeatures> GetFeatures() const;
+
+    union {
+        u32 raw{};
+        BitField<0, 1, u32> lighting_enable;
+        BitField<1, 1, u32> fog_enable;
+        BitField<2, 1, u32> shadow_rendering;
+        BitField<3, 2, Pica::RasterizerRegs::ScissorMode> scissor_test_mode;
+        BitField<5, 1, u32> alpha_test_enable;
+        BitField<6, 1, u32> depth_stencil_enable;
+        BitField<7, 1, u32> alphablend_enable;
+        BitField<8, 4, Pica::FramebufferRegs::LogicOp> logic_op;
+        BitField<12, 4, u32> color_write_mask;
+        BitField<16, 1, u32> color_write_enable;
+    };
+};
+
+} // namespace SwRenderer
@@ -4,12 +4,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <span>
+#include <vector>
 #include "common/thread_worker.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_software/sw_clipper.h"
+#include "video_core/renderer_software/sw_fragment_config.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/renderer_software/sw_texture_cache.h"
 
 namespace Pica {
 struct RegsInternal;
@@ -19,28 +23,68 @@ class PicaCore;
 namespace SwRenderer {
 
 struct Vertex;
+struct Triangle;
 
 class RasterizerSoftware : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerSoftware(Memory::MemorySystem& memory, Pica::PicaCore& pica);
+    ~RasterizerSoftware() override;
 
     void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                      const Pica::OutputVertex& v2) override;
-    void DrawTriangles() override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
-    void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
-    void ClearAll(bool flush) override {}
+    void DrawTriangles() override;
+    void FlushAll() override;
+    void FlushRegion(PAddr addr, u32 size) override;
+    void InvalidateRegion(PAddr addr, u32 size) override;
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void ClearAll(bool flush) override;
+
+    struct FragmentStats {
+        u64 specialized; ///< Fragments shaded by a pipeline specialized for the draw state.
+        u64 generic;     ///< Fragments shaded by the generic pipeline.
+    };
+
+    /// Returns the number of fragments shaded by each kind of fragment pipeline.
+    FragmentStats GetFragmentStats() const;
 
 private:
+    using RasterizeFunc = u32 (RasterizerSoftware::*)(const Triangle&, u32, u32, u32, u32);
+
+    struct FragmentPipeline {
+        RasterizeFunc rasterize{};
+        bool specialized{};
+    };
     /// Computes the screen coordinates of the provided vertex.
     void MakeScreenCoords(Vertex& vtx);
 
-    /// Processes the triangle defined by the provided vertices.
+    /// Sets up the triangle defined by the provided vertices and adds it to the tile bins.
     void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
                          bool reversed = false);
 
+    /// Resizes the tile grid to cover the currently bound framebuffer.
+    void SetupBins();
+
+    /// Rasterizes all binned triangles, one tile per worker, and clears the bins.
+    void FlushTriangles();
+
+    /// Rasterizes every triangle binned in the provided tile in submission order.
+    void RasterizeTile(u32 tile_index);
+
+    /// Looks up the decoded textures sampled by the current batch in the texture cache.
+    void BindTextures();
+
+    /// Returns the fragment pipeline for the provided config, specializing it when possible.
+    FragmentPipeline GetFragmentPipeline(const FragmentConfig& config);
+
+    /**
+     * Rasterizes the part of the triangle that lies inside the provided pixel rectangle and
+     * returns the number of fragments shaded. Specialized instances skip all state checks for
+     * the features that are not part of the feature set.
+     */
+    template <bool Specialized, FragmentFeatures features>
+    u32 RasterizeTriangle(const Triangle& triangle, u32 rect_x1, u32 rect_y1, u32 rect_x2,
+                          u32 rect_y2);
+
     /// Returns the texture color of the currently processed pixel.
     std::array<Common::Vec4<u8>, 4> TextureColor(
         std::span<const Common::Vec2<f24>, 3> uv,
@@ -66,12 +110,26 @@ private:
     bool DoDepthStencilTest(u16 x, u16 y, float depth) const;
 
 private:
+    /// Width and height of a screen tile in pixels.
+    static constexpr u32 TILE_SIZE = 32;
+
     Memory::MemorySystem& memory;
     Pica::PicaCore& pica;
     Pica::RegsInternal& regs;
     std::size_t num_sw_threads;
     Common::ThreadWorker sw_workers;
     Framebuffer fb;
+    TextureCache texture_cache;
+    std::array<const CachedTexture*, 3> bound_textures{};
+    std::array<const CachedTexture*, 6> bound_cube_faces{};
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<u32>> bins;
+    std::vector<u32> active_tiles;
+    u32 num_tiles_x{};
+    u32 num_tiles_y{};
+    FragmentPipeline current_pipeline{};
+    std::atomic<u64> specialized_fragments{};
+    std::atomic<u64> generic_fragments{};
 };
 
 } // namespace SwRenderer
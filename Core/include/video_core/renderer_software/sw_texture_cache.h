@@ -0,0 +1,71 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace SwRenderer {
+
+/// A texture decoded to linear RGBA8. Texels are indexed with the same (s, t) coordinates
+/// that LookupTexture takes.
+struct CachedTexture {
+    PAddr address;
+    u32 width;
+    u32 height;
+    Pica::TexturingRegs::TextureFormat format;
+    u32 size;
+    u64 hash;
+    std::vector<Common::Vec4<u8>> texels;
+
+    [[nodiscard]] Common::Vec4<u8> GetTexel(u32 s, u32 t) const {
+        return texels[t * width + s];
+    }
+};
+
+/**
+ * Caches textures decoded to linear RGBA8, so that sampling does not need to decode the
+ * tiled source format for every texel. The CPU writes guest memory without notifying the
+ * software renderer, so entries are validated against a hash of the source data every
+ * time they are requested.
+ */
+class TextureCache {
+public:
+    explicit TextureCache(Memory::MemorySystem& memory);
+    ~TextureCache();
+
+    /**
+     * Clears the cache if it grew past its size limit. Clearing invalidates every texture
+     * returned so far, so this must be called before the textures of a draw are requested.
+     */
+    void EvictIfFull();
+
+    /// Returns the decoded texture described by info, or nullptr if it cannot be cached.
+    const CachedTexture* GetTexture(const Pica::Texture::TextureInfo& info);
+
+    /// Removes all textures overlapping the provided region.
+    void InvalidateRegion(PAddr addr, u32 size);
+
+    /// Removes all textures.
+    void Clear();
+
+private:
+    /// Decodes the source data into the texel storage of the texture.
+    void Decode(CachedTexture& texture, const u8* source, const Pica::Texture::TextureInfo& info);
+
+private:
+    Memory::MemorySystem& memory;
+    std::unordered_map<u64, CachedTexture> textures;
+    std::size_t cached_size{};
+};
+
+} // namespace SwRenderer
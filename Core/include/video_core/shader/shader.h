@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include "common/common_types.h"
 
 namespace Pica {
@@ -29,6 +30,15 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /**
+     * Runs the currently setup shader for several independent shader units. Engines that can
+     * share work between invocations override this, by default each unit is run in turn.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param states Shader unit states, each setup with the input data of its vertex.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const;
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
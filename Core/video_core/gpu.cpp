@@ -13,6 +13,7 @@
 #include "video_core/gpu.h"
 #include "video_core/gpu_debugger.h"
 #include "video_core/gpu_impl.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/pica/regs_lcd.h"
 #include "video_core/renderer_base.h"
@@ -36,9 +37,20 @@ GPU::GPU(Core::System& system, Frontend::EmuWindow& emu_window,
         "GPU::VBlankCallback",
         [this](uintptr_t user_data, s64 cycles_late) { VBlankCallback(user_data, cycles_late); });
     impl->timing.ScheduleEvent(FRAME_TICKS, impl->vblank_event);
+    impl->sync_event = impl->timing.RegisterEvent(
+        "GPU::SyncCallback",
+        [this](uintptr_t user_data, s64 cycles_late) { SyncCallback(user_data, cycles_late); });
 
     // Bind the rasterizer to the PICA GPU
     impl->pica.BindRasterizer(impl->rasterizer);
+
+    // Only the software backend can process command lists off the emulation thread, the hardware
+    // backends mark cached pages in the guest page table while drawing.
+    if (Settings::values.use_gpu_thread.GetValue() &&
+        Settings::values.graphics_api.GetValue() == Settings::GraphicsAPI::Software) {
+        LOG_INFO(HW_GPU, "Processing GSP commands on a dedicated GPU thread");
+        impl->gpu_thread = std::make_unique<GPUThread>();
+    }
 }
 
 GPU::~GPU() = default;
@@ -70,23 +82,64 @@ PAddr GPU::VirtualToPhysicalAddress(VAddr addr) {
 
 void GPU::SetInterruptHandler(Service::GSP::InterruptHandler handler) {
     impl->signal_interrupt = handler;
-    impl->pica.SetInterruptHandler(handler);
+    if (impl->gpu_thread) {
+        Service::GSP::InterruptHandler deferred_handler = [this](Service::GSP::InterruptId id) {
+            SignalInterrupt(id);
+        };
+        impl->pica.SetInterruptHandler(deferred_handler);
+    } else {
+        impl->pica.SetInterruptHandler(handler);
+    }
 }
 
 void GPU::FlushRegion(PAddr addr, u32 size) {
+    WaitGPUThread();
     impl->rasterizer->FlushRegion(addr, size);
 }
 
 void GPU::InvalidateRegion(PAddr addr, u32 size) {
+    WaitGPUThread();
     impl->rasterizer->InvalidateRegion(addr, size);
 }
 
+void GPU::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    WaitGPUThread();
+    impl->rasterizer->FlushAndInvalidateRegion(addr, size);
+}
+
 void GPU::ClearAll(bool flush) {
+    // This is also the quiescent point savestates are taken at, so deliver any interrupts the
+    // GPU thread raised before the kernel state is serialized.
+    SyncGPUThread();
     impl->rasterizer->ClearAll(flush);
 }
 
 void GPU::Execute(const Service::GSP::Command& command) {
     using Service::GSP::CommandId;
+
+    if (impl->gpu_thread) {
+        switch (command.id) {
+        case CommandId::SubmitCmdList:
+        case CommandId::MemoryFill:
+        case CommandId::DisplayTransfer:
+        case CommandId::TextureCopy:
+            PushWork([this, command] { ExecuteCommand(command); });
+            return;
+        case CommandId::CacheFlush:
+            break;
+        default:
+            // DMA accesses guest memory through the process page table, which may only happen
+            // on the emulation thread once the GPU is done with it.
+            SyncGPUThread();
+            break;
+        }
+    }
+
+    ExecuteCommand(command);
+}
+
+void GPU::ExecuteCommand(const Service::GSP::Command& command) {
+    using Service::GSP::CommandId;
     auto& regs = impl->pica.regs;
 
     switch (command.id) {
@@ -193,29 +246,39 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
     const PAddr phys_address_left = VirtualToPhysicalAddress(info.address_left);
     const PAddr phys_address_right = VirtualToPhysicalAddress(info.address_right);
 
-    // Update framebuffer properties.
-    auto& framebuffer = impl->pica.regs.framebuffer_config[screen_id];
-    if (info.active_fb == 0) {
-        framebuffer.address_left1 = phys_address_left;
-        framebuffer.address_right1 = phys_address_right;
-    } else {
-        framebuffer.address_left2 = phys_address_left;
-        framebuffer.address_right2 = phys_address_right;
-    }
+    // The framebuffer registers are owned by the GPU thread, so the swap is ordered with the
+    // command lists that render into the new buffer.
+    auto swap = [this, screen_id, info, phys_address_left, phys_address_right] {
+        // Update framebuffer properties.
+        auto& framebuffer = impl->pica.regs.framebuffer_config[screen_id];
+        if (info.active_fb == 0) {
+            framebuffer.address_left1 = phys_address_left;
+            framebuffer.address_right1 = phys_address_right;
+        } else {
+            framebuffer.address_left2 = phys_address_left;
+            framebuffer.address_right2 = phys_address_right;
+        }
 
-    framebuffer.stride = info.stride;
-    framebuffer.format = info.format;
-    framebuffer.active_fb = info.shown_fb;
+        framebuffer.stride = info.stride;
+        framebuffer.format = info.format;
+        framebuffer.active_fb = info.shown_fb;
 
-    // Notify debugger about the buffer swap.
-    if (impl->debug_context) {
-        impl->debug_context->OnEvent(Pica::DebugContext::Event::BufferSwapped, nullptr);
-    }
+        // Notify debugger about the buffer swap.
+        if (impl->debug_context) {
+            impl->debug_context->OnEvent(Pica::DebugContext::Event::BufferSwapped, nullptr);
+        }
 
-    if (screen_id == 0) {
-        MicroProfileFlip();
-        impl->system.perf_stats->EndGameFrame();
-        right_eye_disabler->ReportEndFrame();
+        if (screen_id == 0) {
+            MicroProfileFlip();
+            impl->system.perf_stats->EndGameFrame();
+            right_eye_disabler->ReportEndFrame();
+        }
+    };
+
+    if (impl->gpu_thread) {
+        PushWork(std::move(swap));
+    } else {
+        swap();
     }
 }
 
@@ -239,6 +302,7 @@ u32 GPU::ReadReg(VAddr addr) {
         const u32 index = offset / sizeof(u32);
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::PicaCore::Regs::NUM_REGS);
+        WaitGPUThread();
         return impl->pica.regs.reg_array[index];
     }
     default:
@@ -263,27 +327,10 @@ void GPU::WriteReg(VAddr addr, u32 data) {
 
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::PicaCore::Regs::NUM_REGS);
-        impl->pica.regs.reg_array[index] = data;
-
-        // Handle registers that trigger GPU actions
-        switch (index) {
-        case GPU_REG_INDEX(memory_fill_config[0].trigger):
-            MemoryFill(0, 0);
-            break;
-        case GPU_REG_INDEX(memory_fill_config[1].trigger):
-            MemoryFill(1, 1);
-            break;
-        case GPU_REG_INDEX(display_transfer_config.trigger):
-            MemoryTransfer();
-            break;
-        case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
-            SubmitCmdList(0);
-            break;
-        case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]):
-            SubmitCmdList(1);
-            break;
-        default:
-            break;
+        if (impl->gpu_thread) {
+            PushWork([this, index, data] { WriteInternalReg(index, data); });
+        } else {
+            WriteInternalReg(index, data);
         }
         break;
     }
@@ -292,6 +339,35 @@ void GPU::WriteReg(VAddr addr, u32 data) {
     }
 }
 
+void GPU::WriteInternalReg(u32 index, u32 data) {
+    impl->pica.regs.reg_array[index] = data;
+
+    // Handle registers that trigger GPU actions
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+        MemoryFill(0, 0);
+        break;
+    case GPU_REG_INDEX(memory_fill_config[1].trigger):
+        MemoryFill(1, 1);
+        break;
+    case GPU_REG_INDEX(display_transfer_config.trigger):
+        MemoryTransfer();
+        break;
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
+        SubmitCmdList(0);
+        break;
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]):
+        SubmitCmdList(1);
+        break;
+    default:
+        break;
+    }
+}
+
+u64 GPU::GetVBlankCount() const {
+    return impl->vblank_count;
+}
+
 VideoCore::RendererBase& GPU::Renderer() {
     return *impl->renderer;
 }
@@ -329,6 +405,7 @@ void GPU::ReportLoadingProgramID(u64 program_ID) {
             break;
         }
     }
+    WaitGPUThread();
     impl->rasterizer->SetAccurateMul(use_accurate_mul);
 }
 
@@ -365,9 +442,9 @@ void GPU::MemoryFill(u32 index, u32 intr_index) {
     // TODO: hwtest this
     if (config.GetStartAddress() != 0) {
         if (intr_index == 0) {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC0);
+            SignalInterrupt(Service::GSP::InterruptId::PSC0);
         } else if (intr_index == 1) {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC1);
+            SignalInterrupt(Service::GSP::InterruptId::PSC1);
         }
     }
 
@@ -407,21 +484,73 @@ void GPU::MemoryTransfer() {
 
     // Complete transfer.
     config.trigger.Assign(0);
-    impl->signal_interrupt(Service::GSP::InterruptId::PPF);
+    SignalInterrupt(Service::GSP::InterruptId::PPF);
 }
 
 void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
     // Present renderered frame.
+    WaitGPUThread();
     impl->renderer->SwapBuffers();
 
     // Signal to GSP that GPU interrupt has occurred
     impl->signal_interrupt(Service::GSP::InterruptId::PDC0);
     impl->signal_interrupt(Service::GSP::InterruptId::PDC1);
 
+    impl->vblank_count++;
+
     // Reschedule recurrent event
     impl->timing.ScheduleEvent(FRAME_TICKS - cycles_late, impl->vblank_event);
 }
 
+void GPU::SyncCallback(std::uintptr_t user_data, s64 cycles_late) {
+    impl->sync_pending = false;
+    SyncGPUThread();
+}
+
+void GPU::PushWork(Common::UniqueFunction<void>&& work) {
+    impl->gpu_thread->Push(std::move(work));
+
+    // The guest only observes completion through interrupts, so rather than waiting right away
+    // let the CPU run ahead and synchronize after a fixed emulated latency.
+    if (!impl->sync_pending) {
+        impl->sync_pending = true;
+        impl->timing.ScheduleEvent(GPU_SYNC_TICKS, impl->sync_event);
+    }
+}
+
+void GPU::WaitGPUThread() {
+    if (impl->gpu_thread) {
+        impl->gpu_thread->WaitIdle();
+    }
+}
+
+void GPU::SyncGPUThread() {
+    if (!impl->gpu_thread) {
+        return;
+    }
+
+    impl->gpu_thread->WaitIdle();
+
+    std::vector<Service::GSP::InterruptId> interrupts;
+    {
+        std::scoped_lock lock{impl->interrupt_mutex};
+        interrupts.swap(impl->pending_interrupts);
+    }
+    for (const auto id : interrupts) {
+        impl->signal_interrupt(id);
+    }
+}
+
+void GPU::SignalInterrupt(Service::GSP::InterruptId id) {
+    // With a GPU thread this is only reached from queued work, which must not touch kernel state.
+    if (impl->gpu_thread) {
+        std::scoped_lock lock{impl->interrupt_mutex};
+        impl->pending_interrupts.push_back(id);
+        return;
+    }
+    impl->signal_interrupt(id);
+}
+
 template <class Archive>
 void GPU::serialize(Archive& ar, const u32 file_version) {
     ar & impl->pica;
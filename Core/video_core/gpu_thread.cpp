@@ -0,0 +1,66 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/thread.h"
+#include "common/microprofile.h"
+#include "video_core/gpu_thread.h"
+
+namespace VideoCore {
+
+MICROPROFILE_DEFINE(GPU_WaitForThread, "GPU", "Wait For GPU Thread", MP_RGB(255, 100, 100));
+
+GPUThread::GPUThread()
+    : thread{[this](std::stop_token stop_token) { ThreadLoop(stop_token); }} {}
+
+GPUThread::~GPUThread() {
+    WaitIdle();
+}
+
+u64 GPUThread::Push(Work&& work) {
+    u64 fence;
+    {
+        std::scoped_lock lock{queue_mutex};
+        fence = ++submitted_fence;
+        work_queue.emplace(fence, std::move(work));
+    }
+    work_cv.notify_one();
+    return fence;
+}
+
+void GPUThread::WaitFor(u64 fence) {
+    if (completed_fence.load(std::memory_order_acquire) >= fence) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_WaitForThread);
+    std::unique_lock lock{queue_mutex};
+    done_cv.wait(lock, [&] { return completed_fence.load(std::memory_order_relaxed) >= fence; });
+}
+
+void GPUThread::ThreadLoop(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("GPUThread");
+
+    while (!stop_token.stop_requested()) {
+        std::pair<u64, Work> work;
+        {
+            std::unique_lock lock{queue_mutex};
+            Common::CondvarWait(work_cv, lock, stop_token, [this] { return !work_queue.empty(); });
+            if (stop_token.stop_requested()) {
+                return;
+            }
+            work = std::move(work_queue.front());
+            work_queue.pop();
+        }
+
+        work.second();
+
+        {
+            std::scoped_lock lock{queue_mutex};
+            completed_fence.store(work.first, std::memory_order_release);
+        }
+        done_cv.notify_all();
+    }
+}
+
+} // namespace VideoCore
@@ -2,6 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <thread>
+
 #include "common/arch.h"
 #include "common/archives.h"
 #include "common/microprofile.h"
@@ -33,7 +39,8 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext> debug_context_)
     : memory{memory_}, debug_context{std::move(debug_context_)},
       geometry_pipeline{regs.internal, gs_unit, gs_setup},
-      shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())} {
+      shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())},
+      num_vs_threads{std::max(std::thread::hardware_concurrency(), 2U)} {
     InitializeRegs();
 
     const auto submit_vertex = [this](const AttributeBuffer& buffer) {
@@ -583,16 +590,7 @@ void PicaCore::LoadVertices(bool is_indexed) {
     const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
     const bool index_u16 = index_info.format != 0;
 
-    // Simple circular-replacement vertex cache
-    const std::size_t VERTEX_CACHE_SIZE = 64;
-    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-    std::array<AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-    u32 vertex_cache_pos = 0;
-
     // Compile the vertex shader for this batch.
-    ShaderUnit shader_unit;
-    AttributeBuffer vs_output;
     shader_engine->SetupBatch(vs_setup, regs.internal.vs.main_offset);
 
     // Setup geometry pipeline in case we are using a geometry shader.
@@ -600,11 +598,64 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
-    for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+    const auto get_vertex = [&](u32 index) -> u32 {
         // Indexed rendering doesn't use the start offset
-        const u32 vertex = is_indexed
-                               ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                               : (index + pipeline.vertex_offset);
+        return is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                          : (index + pipeline.vertex_offset);
+    };
+
+    // Large batches are shaded up front on the vertex workers. Primitive assembly and the
+    // geometry shader still consume the results in submission order on this thread.
+    if (pipeline.num_vertices >= PARALLEL_VERTEX_THRESHOLD &&
+        !geometry_pipeline.NeedIndexInput() && !debug_context) {
+        shade_vertex_ids.clear();
+        if (is_indexed) {
+            // Only shade each distinct vertex of the batch once.
+            if (vertex_slots.empty()) {
+                vertex_slots.resize(std::numeric_limits<u16>::max() + 1);
+                vertex_slot_generations.resize(vertex_slots.size());
+            }
+            if (++vertex_generation == 0) {
+                std::ranges::fill(vertex_slot_generations, 0);
+                vertex_generation = 1;
+            }
+            index_slots.resize(pipeline.num_vertices);
+            for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+                const u32 vertex = get_vertex(index);
+                if (vertex_slot_generations[vertex] != vertex_generation) {
+                    vertex_slot_generations[vertex] = vertex_generation;
+                    vertex_slots[vertex] = static_cast<u32>(shade_vertex_ids.size());
+                    shade_vertex_ids.push_back(vertex);
+                }
+                index_slots[index] = vertex_slots[vertex];
+            }
+        } else {
+            for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+                shade_vertex_ids.push_back(get_vertex(index));
+            }
+        }
+
+        ShadeVerticesParallel(loader, base_address);
+
+        for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+            const u32 slot = is_indexed ? index_slots[index] : index;
+            geometry_pipeline.SubmitVertex(vs_outputs[slot]);
+        }
+        return;
+    }
+
+    // Simple direct-mapped vertex cache
+    constexpr std::size_t VERTEX_CACHE_SIZE = 64;
+    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
+    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
+    std::array<AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
+
+    ShaderUnit shader_unit;
+    AttributeBuffer vs_output;
+
+    for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+        const u32 vertex = get_vertex(index);
+        const std::size_t cache_slot = vertex % VERTEX_CACHE_SIZE;
 
         bool vertex_cache_hit = false;
         if (is_indexed) {
@@ -613,12 +664,9 @@ void PicaCore::LoadVertices(bool is_indexed) {
                 continue;
             }
 
-            for (u32 i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                    vs_output = vertex_cache[i];
-                    vertex_cache_hit = true;
-                    break;
-                }
+            if (vertex_cache_valid[cache_slot] && vertex == vertex_cache_ids[cache_slot]) {
+                vs_output = vertex_cache[cache_slot];
+                vertex_cache_hit = true;
             }
         }
 
@@ -640,10 +688,9 @@ void PicaCore::LoadVertices(bool is_indexed) {
 
             // Cache the vertex when doing indexed rendering.
             if (is_indexed) {
-                vertex_cache[vertex_cache_pos] = vs_output;
-                vertex_cache_valid[vertex_cache_pos] = true;
-                vertex_cache_ids[vertex_cache_pos] = vertex;
-                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                vertex_cache[cache_slot] = vs_output;
+                vertex_cache_valid[cache_slot] = true;
+                vertex_cache_ids[cache_slot] = static_cast<u16>(vertex);
             }
         }
 
@@ -652,6 +699,49 @@ void PicaCore::LoadVertices(bool is_indexed) {
     }
 }
 
+void PicaCore::ShadeVerticesParallel(const VertexLoader& loader, PAddr base_address) {
+    constexpr u32 VERTEX_CHUNK_SIZE = 64;
+    constexpr u32 VERTEX_BATCH_SIZE = 16;
+
+    if (!vs_workers) {
+        vs_workers = std::make_unique<Common::ThreadWorker>(num_vs_threads, "Vertex shader");
+    }
+
+    const u32 num_shaded = static_cast<u32>(shade_vertex_ids.size());
+    const u32 num_chunks = (num_shaded + VERTEX_CHUNK_SIZE - 1) / VERTEX_CHUNK_SIZE;
+    vs_outputs.resize(num_shaded);
+
+    // Every worker owns a batch of shader units and pulls chunks of vertices until none are
+    // left. The vertices of a chunk are handed to the shader engine a batch at a time.
+    std::atomic<u32> next_chunk{0};
+    const auto shade_chunks = [&] {
+        std::array<ShaderUnit, VERTEX_BATCH_SIZE> shader_units;
+        AttributeBuffer input;
+        for (u32 chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++) {
+            const u32 chunk_end = std::min((chunk + 1) * VERTEX_CHUNK_SIZE, num_shaded);
+            for (u32 begin = chunk * VERTEX_CHUNK_SIZE; begin < chunk_end;
+                 begin += VERTEX_BATCH_SIZE) {
+                const u32 count = std::min(VERTEX_BATCH_SIZE, chunk_end - begin);
+                for (u32 i = 0; i < count; ++i) {
+                    loader.LoadVertex(base_address, begin + i, shade_vertex_ids[begin + i], input,
+                                      input_default_attributes);
+                    shader_units[i].LoadInput(regs.internal.vs, input);
+                }
+                shader_engine->RunBatch(vs_setup, std::span{shader_units.data(), count});
+                for (u32 i = 0; i < count; ++i) {
+                    shader_units[i].WriteOutput(regs.internal.vs, vs_outputs[begin + i]);
+                }
+            }
+        }
+    };
+
+    const std::size_t num_jobs = std::min<std::size_t>(num_vs_threads, num_chunks);
+    for (std::size_t i = 0; i < num_jobs; i++) {
+        vs_workers->QueueWork(shade_chunks);
+    }
+    vs_workers->WaitForRequests();
+}
+
 PicaCore::RenderPropertiesGuess PicaCore::GuessCmdRenderProperties(PAddr list, u32 size) {
     // Initialize command list tracking.
     const u8* head = memory.GetPhysicalPointer(list);
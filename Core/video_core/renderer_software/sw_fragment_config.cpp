@@ -0,0 +1,62 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/renderer_software/sw_fragment_config.h"
+
+namespace SwRenderer {
+
+using Pica::FramebufferRegs;
+using Pica::RasterizerRegs;
+using Pica::TexturingRegs;
+
+FragmentConfig::FragmentConfig(const Pica::RegsInternal& regs) {
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+    const auto& output_merger = regs.framebuffer.output_merger;
+
+    lighting_enable.Assign(!regs.lighting.disable);
+    fog_enable.Assign(regs.texturing.fog_mode == TexturingRegs::FogMode::Fog);
+    shadow_rendering.Assign(output_merger.fragment_operation_mode ==
+                            FramebufferRegs::FragmentOperationMode::Shadow);
+    scissor_test_mode.Assign(regs.rasterizer.scissor_test.mode);
+    alpha_test_enable.Assign(output_merger.alpha_test.enable);
+
+    // The depth stencil unit has no effect when it can neither reject nor write anything.
+    const bool stencil_enable = output_merger.stencil_test.enable &&
+                                framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
+    const bool depth_write =
+        framebuffer.allow_depth_stencil_write != 0 && output_merger.depth_write_enable;
+    depth_stencil_enable.Assign(output_merger.depth_test_enable || depth_write || stencil_enable);
+
+    alphablend_enable.Assign(output_merger.alphablend_enable);
+    logic_op.Assign(output_merger.logic_op);
+    color_write_mask.Assign(output_merger.red_enable | output_merger.green_enable << 1 |
+                            output_merger.blue_enable << 2 | output_merger.alpha_enable << 3);
+    color_write_enable.Assign(framebuffer.allow_color_write != 0);
+}
+
+std::optional<FragmentFeatures> FragmentConfig::GetFeatures() const {
+    if (fog_enable || shadow_rendering || !color_write_enable ||
+        scissor_test_mode == RasterizerRegs::ScissorMode::Exclude) {
+        return std::nullopt;
+    }
+
+    FragmentFeatures features = FragmentFeatures::None;
+    if (lighting_enable) {
+        features |= FragmentFeatures::Lighting;
+    }
+    if (alpha_test_enable) {
+        features |= FragmentFeatures::AlphaTest;
+    }
+    if (depth_stencil_enable) {
+        features |= FragmentFeatures::DepthStencil;
+    }
+    // The output merger reduces to a plain store of the combiner output.
+    if (!alphablend_enable && logic_op == FramebufferRegs::LogicOp::Copy &&
+        color_write_mask == 0xF) {
+        features |= FragmentFeatures::ColorCopy;
+    }
+    return features;
+}
+
+} // namespace SwRenderer
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <utility>
 #include <boost/container/static_vector.hpp>
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -17,6 +20,14 @@
 #include "video_core/renderer_software/sw_texturing.h"
 #include "video_core/texture/texture_decode.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define CITRA_HAS_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define CITRA_HAS_NEON
+#include <arm_neon.h>
+#endif
+
 namespace SwRenderer {
 
 using Pica::f24;
@@ -66,6 +77,17 @@ struct Vertex : Pica::OutputVertex {
     }
 };
 
+/// Setup data of a triangle that is waiting in the tile bins to be rasterized.
+struct Triangle {
+    std::array<Vertex, 3> vertices;
+    std::array<Common::Vec3<Fix12P4>, 3> vtxpos;
+    std::array<int, 3> bias;
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
+
 namespace {
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
@@ -98,12 +120,162 @@ private:
     Common::Vec4<f24> bias;
 };
 
+struct ScissorBox {
+    u16 x1;
+    u16 y1;
+    u16 x2;
+    u16 y2;
+};
+
+/// Size in pixels of the blocks that are tested for trivial rejection before rasterizing quads.
+constexpr s32 RASTER_BLOCK_SIZE = 8;
+
+/**
+ * Edge function of a triangle edge, equivalent to bias + SignedArea(vtx1, vtx2, pos).
+ * Being linear in the pixel position, it can be evaluated incrementally while stepping
+ * over the bounding box, which gives exactly the same integer result as the cross product.
+ **/
+struct EdgeFunction {
+    EdgeFunction(const Common::Vec2<Fix12P4>& vtx1, const Common::Vec2<Fix12P4>& vtx2, int bias)
+        : a{vtx1.y - vtx2.y}, b{vtx2.x - vtx1.x}, c{bias - a * vtx1.x - b * vtx1.y} {}
+
+    /// Evaluates the edge function at the center of the provided pixel.
+    s32 Evaluate(s32 pixel_x, s32 pixel_y) const {
+        return a * ((pixel_x << 4) + 8) + b * ((pixel_y << 4) + 8) + c;
+    }
+
+    /// Returns true if all pixels of the inclusive block are on the outer side of the edge.
+    bool IsBlockOutside(s32 x1, s32 y1, s32 x2, s32 y2) const {
+        // The function is linear, so its maximum over the block is found at one of the corners.
+        return Evaluate(a > 0 ? x2 : x1, b > 0 ? y2 : y1) < 0;
+    }
+
+    /// Difference of the edge function between horizontally adjacent pixels.
+    s32 StepX() const {
+        return a << 4;
+    }
+
+    /// Difference of the edge function between vertically adjacent pixels.
+    s32 StepY() const {
+        return b << 4;
+    }
+
+    s32 a;
+    s32 b;
+    s32 c;
+};
+
+/**
+ * Edge function values of the three triangle edges at the pixels of a 2x2 quad.
+ * Lane 0 is the top-left pixel, lane 1 top-right, lane 2 bottom-left and lane 3 bottom-right.
+ **/
+class QuadEdges {
+public:
+    QuadEdges(const std::array<EdgeFunction, 3>& edges, s32 pixel_x, s32 pixel_y) {
+        for (std::size_t i = 0; i < edges.size(); i++) {
+            const EdgeFunction& edge = edges[i];
+            const s32 value = edge.Evaluate(pixel_x, pixel_y);
+            const std::array<s32, 4> lanes = {value, value + edge.StepX(), value + edge.StepY(),
+                                              value + edge.StepX() + edge.StepY()};
+#if defined(CITRA_HAS_SSE2)
+            values[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.data()));
+            steps[i] = _mm_set1_epi32(edge.StepX() * 2);
+#elif defined(CITRA_HAS_NEON)
+            values[i] = vld1q_s32(lanes.data());
+            steps[i] = vdupq_n_s32(edge.StepX() * 2);
+#else
+            values[i] = lanes;
+            steps[i] = edge.StepX() * 2;
+#endif
+        }
+    }
+
+    /// Moves the quad two pixels to the right.
+    void StepX() {
+        for (std::size_t i = 0; i < std::size(values); i++) {
+#if defined(CITRA_HAS_SSE2)
+            values[i] = _mm_add_epi32(values[i], steps[i]);
+#elif defined(CITRA_HAS_NEON)
+            values[i] = vaddq_s32(values[i], steps[i]);
+#else
+            for (s32& value : values[i]) {
+                value += steps[i];
+            }
+#endif
+        }
+    }
+
+    /// Returns a mask with one bit per lane that is set when the pixel is covered by the triangle.
+    u32 CoverageMask() const {
+#if defined(CITRA_HAS_SSE2)
+        const __m128i outside = _mm_or_si128(_mm_or_si128(values[0], values[1]), values[2]);
+        return ~static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(outside))) & 0xF;
+#elif defined(CITRA_HAS_NEON)
+        static constexpr std::array<u32, 4> lane_bits = {1, 2, 4, 8};
+        const int32x4_t outside = vorrq_s32(vorrq_s32(values[0], values[1]), values[2]);
+        const uint32x4_t inside = vcgeq_s32(outside, vdupq_n_s32(0));
+        return vaddvq_u32(vandq_u32(inside, vld1q_u32(lane_bits.data())));
+#else
+        u32 mask = 0;
+        for (u32 lane = 0; lane < 4; lane++) {
+            const s32 outside = values[0][lane] | values[1][lane] | values[2][lane];
+            mask |= outside >= 0 ? (1U << lane) : 0;
+        }
+        return mask;
+#endif
+    }
+
+    /// Returns the edge function values of each lane.
+    std::array<std::array<s32, 4>, 3> Values() const {
+#if defined(CITRA_HAS_SSE2) || defined(CITRA_HAS_NEON)
+        std::array<std::array<s32, 4>, 3> lanes;
+        for (std::size_t i = 0; i < std::size(values); i++) {
+#if defined(CITRA_HAS_SSE2)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[i].data()), values[i]);
+#else
+            vst1q_s32(lanes[i].data(), values[i]);
+#endif
+        }
+        return lanes;
+#else
+        return values;
+#endif
+    }
+
+private:
+    // Plain arrays, as std::array of a vector type drops its alignment attributes.
+#if defined(CITRA_HAS_SSE2)
+    __m128i values[3];
+    __m128i steps[3];
+#elif defined(CITRA_HAS_NEON)
+    int32x4_t values[3];
+    int32x4_t steps[3];
+#else
+    std::array<std::array<s32, 4>, 3> values;
+    std::array<s32, 3> steps;
+#endif
+};
+
+/// Returns the scissor box in 12.4 fixed point rasterizer coordinates.
+ScissorBox GetScissorBox(const RasterizerRegs& rasterizer) {
+    // x2,y2 have +1 added to cover the entire sub-pixel area
+    return {
+        .x1 = static_cast<u16>(rasterizer.scissor_test.x1 << 4),
+        .y1 = static_cast<u16>(rasterizer.scissor_test.y1 << 4),
+        .x2 = static_cast<u16>((rasterizer.scissor_test.x2 + 1) << 4),
+        .y2 = static_cast<u16>((rasterizer.scissor_test.y2 + 1) << 4),
+    };
+}
+
 } // Anonymous namespace
 
 RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::PicaCore& pica_)
     : memory{memory_}, pica{pica_}, regs{pica.regs.internal},
       num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
-      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
+      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer},
+      texture_cache{memory} {}
+
+RasterizerSoftware::~RasterizerSoftware() = default;
 
 void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                                      const Pica::OutputVertex& v2) {
@@ -205,6 +377,32 @@ void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::O
     }
 }
 
+void RasterizerSoftware::DrawTriangles() {
+    FlushTriangles();
+}
+
+void RasterizerSoftware::FlushAll() {
+    FlushTriangles();
+}
+
+void RasterizerSoftware::FlushRegion(PAddr addr, u32 size) {
+    FlushTriangles();
+}
+
+void RasterizerSoftware::InvalidateRegion(PAddr addr, u32 size) {
+    texture_cache.InvalidateRegion(addr, size);
+}
+
+void RasterizerSoftware::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    FlushTriangles();
+    texture_cache.InvalidateRegion(addr, size);
+}
+
+void RasterizerSoftware::ClearAll(bool flush) {
+    FlushTriangles();
+    texture_cache.Clear();
+}
+
 void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
     Viewport viewport{};
     viewport.halfsize_x = f24::FromRaw(regs.rasterizer.viewport_size_x);
@@ -229,8 +427,6 @@ void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
 
 void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
                                          bool reversed) {
-    MICROPROFILE_SCOPE(GPU_Rasterization);
-
     // Vertex positions in rasterizer coordinates
     static auto screen_to_rasterizer_coords = [](const Common::Vec3<f24>& vec) {
         return Common::Vec3{Fix12P4::FromFloat24(vec.x), Fix12P4::FromFloat24(vec.y),
@@ -266,19 +462,13 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
     u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
 
-    // Convert the scissor box coordinates to 12.4 fixed point
-    const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
-    const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
-    // x2,y2 have +1 added to cover the entire sub-pixel area
-    const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
-    const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
-
     if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
         // Calculate the new bounds
-        min_x = std::max(min_x, scissor_x1);
-        min_y = std::max(min_y, scissor_y1);
-        max_x = std::min(max_x, scissor_x2);
-        max_y = std::min(max_y, scissor_y2);
+        const auto scissor = GetScissorBox(regs.rasterizer);
+        min_x = std::max(min_x, scissor.x1);
+        min_y = std::max(min_y, scissor.y1);
+        max_x = std::min(max_x, scissor.x2);
+        max_y = std::min(max_y, scissor.y2);
     }
 
     min_x &= Fix12P4::IntMask();
@@ -286,6 +476,15 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
 
+    // Nothing to rasterize if the bounding box does not contain any pixel centers.
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    if (triangles.empty()) {
+        SetupBins();
+    }
+
     const int bias0 =
         IsRightSideOrFlatBottomEdge(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) ? -1 : 0;
     const int bias1 =
@@ -293,182 +492,381 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     const int bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
 
+    const u32 triangle_index = static_cast<u32>(triangles.size());
+    triangles.push_back(Triangle{
+        .vertices = {v0, v1, v2},
+        .vtxpos = vtxpos,
+        .bias = {bias0, bias1, bias2},
+        .min_x = min_x,
+        .min_y = min_y,
+        .max_x = max_x,
+        .max_y = max_y,
+    });
+
+    // Add the triangle to every tile its bounding box overlaps. The last row and column of
+    // tiles also receive everything that lies past the edge of the framebuffer.
+    const u32 tile_x1 = std::min<u32>((min_x >> 4) / TILE_SIZE, num_tiles_x - 1);
+    const u32 tile_y1 = std::min<u32>((min_y >> 4) / TILE_SIZE, num_tiles_y - 1);
+    const u32 tile_x2 = std::min<u32>(((max_x >> 4) - 1) / TILE_SIZE, num_tiles_x - 1);
+    const u32 tile_y2 = std::min<u32>(((max_y >> 4) - 1) / TILE_SIZE, num_tiles_y - 1);
+    for (u32 tile_y = tile_y1; tile_y <= tile_y2; tile_y++) {
+        for (u32 tile_x = tile_x1; tile_x <= tile_x2; tile_x++) {
+            auto& bin = bins[tile_y * num_tiles_x + tile_x];
+            if (bin.empty()) {
+                active_tiles.push_back(tile_y * num_tiles_x + tile_x);
+            }
+            bin.push_back(triangle_index);
+        }
+    }
+}
+
+void RasterizerSoftware::SetupBins() {
+    // NOTE: The framebuffer height register contains the actual FB height minus one.
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+    num_tiles_x = std::max<u32>((framebuffer.width + TILE_SIZE - 1) / TILE_SIZE, 1);
+    num_tiles_y = std::max<u32>((framebuffer.height + TILE_SIZE) / TILE_SIZE, 1);
+    if (bins.size() < num_tiles_x * num_tiles_y) {
+        bins.resize(num_tiles_x * num_tiles_y);
+    }
+}
+
+void RasterizerSoftware::FlushTriangles() {
+    if (triangles.empty()) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Rasterization);
+
+    fb.Bind();
+    BindTextures();
+    current_pipeline = GetFragmentPipeline(FragmentConfig{regs});
+
+    // Every tile is owned by a single thread, which preserves the submission order of the
+    // triangles within it. Small batches that only touch one tile are drawn inline.
+    if (active_tiles.size() == 1) {
+        RasterizeTile(active_tiles[0]);
+    } else {
+        std::atomic<std::size_t> next_tile{0};
+        const std::size_t num_jobs = std::min(num_sw_threads, active_tiles.size());
+        for (std::size_t i = 0; i < num_jobs; i++) {
+            sw_workers.QueueWork([this, &next_tile] {
+                std::size_t index;
+                while ((index = next_tile.fetch_add(1, std::memory_order_relaxed)) <
+                       active_tiles.size()) {
+                    RasterizeTile(active_tiles[index]);
+                }
+            });
+        }
+        sw_workers.WaitForRequests();
+    }
+
+    for (const u32 tile_index : active_tiles) {
+        bins[tile_index].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
+}
+
+void RasterizerSoftware::RasterizeTile(u32 tile_index) {
+    // Tile bounds in rasterizer coordinates (12.4 fixed point).
+    static constexpr u32 TILE_EXTENT = TILE_SIZE << 4;
+    const u32 tile_x = tile_index % num_tiles_x;
+    const u32 tile_y = tile_index / num_tiles_x;
+    const u32 rect_x1 = tile_x * TILE_EXTENT;
+    const u32 rect_y1 = tile_y * TILE_EXTENT;
+    const u32 rect_x2 = tile_x == num_tiles_x - 1 ? 0x10000 : rect_x1 + TILE_EXTENT;
+    const u32 rect_y2 = tile_y == num_tiles_y - 1 ? 0x10000 : rect_y1 + TILE_EXTENT;
+
+    u64 num_fragments = 0;
+    for (const u32 triangle_index : bins[tile_index]) {
+        num_fragments += (this->*current_pipeline.rasterize)(triangles[triangle_index], rect_x1,
+                                                             rect_y1, rect_x2, rect_y2);
+    }
+    auto& counter = current_pipeline.specialized ? specialized_fragments : generic_fragments;
+    counter.fetch_add(num_fragments, std::memory_order_relaxed);
+}
+
+void RasterizerSoftware::BindTextures() {
+    bound_textures.fill(nullptr);
+    bound_cube_faces.fill(nullptr);
+    texture_cache.EvictIfFull();
+
+    const auto textures = regs.texturing.GetTextures();
+    for (u32 i = 0; i < textures.size(); ++i) {
+        const auto& texture = textures[i];
+        if (!texture.enabled || texture.config.address == 0) {
+            continue;
+        }
+
+        const auto type = texture.config.type.Value();
+        if (i == 0 && type == TexturingRegs::TextureConfig::Disabled) {
+            continue;
+        }
+
+        auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
+        if (i == 0 && (type == TexturingRegs::TextureConfig::TextureCube ||
+                       type == TexturingRegs::TextureConfig::ShadowCube)) {
+            for (u32 face = 0; face < bound_cube_faces.size(); ++face) {
+                info.physical_address = regs.texturing.GetCubePhysicalAddress(
+                    static_cast<TexturingRegs::CubeFace>(face));
+                bound_cube_faces[face] = texture_cache.GetTexture(info);
+            }
+            continue;
+        }
+        bound_textures[i] = texture_cache.GetTexture(info);
+    }
+}
+
+RasterizerSoftware::FragmentPipeline RasterizerSoftware::GetFragmentPipeline(
+    const FragmentConfig& config) {
+    static constexpr auto specialized_pipelines = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<RasterizeFunc, sizeof...(I)>{
+            &RasterizerSoftware::RasterizeTriangle<true, static_cast<FragmentFeatures>(I)>...};
+    }(std::make_index_sequence<NUM_FRAGMENT_FEATURE_SETS>{});
+
+    const auto features = config.GetFeatures();
+    if (!features) {
+        return {&RasterizerSoftware::RasterizeTriangle<false, FragmentFeatures::None>, false};
+    }
+    return {specialized_pipelines[static_cast<u32>(*features)], true};
+}
+
+RasterizerSoftware::FragmentStats RasterizerSoftware::GetFragmentStats() const {
+    return {
+        .specialized = specialized_fragments.load(std::memory_order_relaxed),
+        .generic = generic_fragments.load(std::memory_order_relaxed),
+    };
+}
+
+template <bool Specialized, FragmentFeatures features>
+u32 RasterizerSoftware::RasterizeTriangle(const Triangle& triangle, u32 rect_x1, u32 rect_y1,
+                                          u32 rect_x2, u32 rect_y2) {
+    const auto& [v0, v1, v2] = triangle.vertices;
+    const auto& vtxpos = triangle.vtxpos;
+    const auto& bias = triangle.bias;
+
+    // Pixel bounds of the triangle inside the rectangle. Both are aligned to whole pixels.
+    const s32 x_begin = std::max<u32>(triangle.min_x, rect_x1) >> 4;
+    const s32 y_begin = std::max<u32>(triangle.min_y, rect_y1) >> 4;
+    const s32 x_end = std::min<u32>(triangle.max_x, rect_x2) >> 4;
+    const s32 y_end = std::min<u32>(triangle.max_y, rect_y2) >> 4;
+    if (x_begin >= x_end || y_begin >= y_end) {
+        return 0;
+    }
+
+    // Barycentric coordinates w0, w1 and w2 as edge functions of the pixel position.
+    const std::array<EdgeFunction, 3> edges = {
+        EdgeFunction{vtxpos[1].xy(), vtxpos[2].xy(), bias[0]},
+        EdgeFunction{vtxpos[2].xy(), vtxpos[0].xy(), bias[1]},
+        EdgeFunction{vtxpos[0].xy(), vtxpos[1].xy(), bias[2]},
+    };
+
+    // Attribute state that is constant over the whole triangle.
+    const auto scissor = GetScissorBox(regs.rasterizer);
     const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
+    const std::array<float, 3> z = {v0.screenpos[2].ToFloat32(), v1.screenpos[2].ToFloat32(),
+                                    v2.screenpos[2].ToFloat32()};
+    const float depth_scale = f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    const float depth_offset = f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
 
     const auto textures = regs.texturing.GetTextures();
     const auto tev_stages = regs.texturing.GetTevStages();
 
-    fb.Bind();
+    // Specialized pipelines only run for states without fog, shadow rendering, exclusive scissor
+    // and with color writes allowed. They resolve the remaining feature checks at compile time.
+    constexpr bool lighting = !Specialized || True(features & FragmentFeatures::Lighting);
+    constexpr bool alpha_test = !Specialized || True(features & FragmentFeatures::AlphaTest);
+    constexpr bool depth_stencil = !Specialized || True(features & FragmentFeatures::DepthStencil);
+    constexpr bool color_copy = Specialized && True(features & FragmentFeatures::ColorCopy);
+
+    u32 num_fragments = 0;
+    const auto shade_pixel = [&](u16 x, u16 y, s32 w0, s32 w1, s32 w2) {
+        // Do not process the pixel if it's inside the scissor box and the scissor mode is
+        // set to Exclude.
+        if (!Specialized &&
+            regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
+            if (x >= scissor.x1 && x < scissor.x2 && y >= scissor.y1 && y < scissor.y2) {
+                return;
+            }
+        }
+        num_fragments++;
 
-    // Enter rasterization loop, starting at the center of the topleft bounding box corner.
-    // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        const auto process_scanline = [&, y] {
-            for (u16 x = min_x + 8; x < max_x; x += 0x10) {
-                // Do not process the pixel if it's inside the scissor box and the scissor mode is
-                // set to Exclude.
-                if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
-                    if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2) {
-                        continue;
-                    }
-                }
+        const s32 wsum = w0 + w1 + w2;
 
-                // Calculate the barycentric coordinates w0, w1 and w2
-                const s32 w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-                const s32 w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-                const s32 w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-                const s32 wsum = w0 + w1 + w2;
+        const auto baricentric_coordinates = Common::MakeVec(
+            f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
+            f24::FromFloat32(static_cast<f32>(w2)));
+        const f24 interpolated_w_inverse =
+            f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
 
-                // If current pixel is not covered by the current primitive
-                if (w0 < 0 || w1 < 0 || w2 < 0) {
-                    continue;
-                }
+        // interpolated_z = z / w
+        const float interpolated_z_over_w = (z[0] * w0 + z[1] * w1 + z[2] * w2) / wsum;
 
-                const auto baricentric_coordinates = Common::MakeVec(
-                    f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
-                    f24::FromFloat32(static_cast<f32>(w2)));
-                const f24 interpolated_w_inverse =
-                    f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
-
-                // interpolated_z = z / w
-                const float interpolated_z_over_w =
-                    (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                     v2.screenpos[2].ToFloat32() * w2) /
-                    wsum;
-
-                // Not fully accurate. About 3 bits in precision are missing.
-                // Z-Buffer (z / w * scale + offset)
-                const float depth_scale =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-                const float depth_offset =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-                float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-                // Potentially switch to W-Buffer
-                if (regs.rasterizer.depthmap_enable ==
-                    Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                    // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                    depth *= interpolated_w_inverse.ToFloat32() * wsum;
-                }
+        // Not fully accurate. About 3 bits in precision are missing.
+        // Z-Buffer (z / w * scale + offset)
+        float depth = interpolated_z_over_w * depth_scale + depth_offset;
 
-                // Clamp the result
-                depth = std::clamp(depth, 0.0f, 1.0f);
-
-                /**
-                 * Perspective correct attribute interpolation:
-                 * Attribute values cannot be calculated by simple linear interpolation since
-                 * they are not linear in screen space. For example, when interpolating a
-                 * texture coordinate across two vertices, something simple like
-                 *     u = (u0*w0 + u1*w1)/(w0+w1)
-                 * will not work. However, the attribute value divided by the
-                 * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
-                 * in screenspace. Hence, we can linearly interpolate these two independently and
-                 * calculate the interpolated attribute by dividing the results.
-                 * I.e.
-                 *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
-                 *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
-                 *     u = u_over_w / one_over_w
-                 *
-                 * The generalization to three vertices is straightforward in baricentric
-                 *coordinates.
-                 **/
-                const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
-                    auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
-                    f24 interpolated_attr_over_w =
-                        Common::Dot(attr_over_w, baricentric_coordinates);
-                    return interpolated_attr_over_w * interpolated_w_inverse;
-                };
-
-                const Common::Vec4<u8> primary_color{
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a())
-                                  .ToFloat32() *
-                              255)),
-                };
-
-                std::array<Common::Vec2<f24>, 3> uv;
-                uv[0].u() = get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
-                uv[0].v() = get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
-                uv[1].u() = get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
-                uv[1].v() = get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
-                uv[2].u() = get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
-                uv[2].v() = get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
-
-                // Sample bound texture units.
-                const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
-                const auto texture_color = TextureColor(uv, textures, tc0_w);
-
-                Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
-                Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
-
-                if (!regs.lighting.disable) {
-                    const auto normquat =
-                        Common::Quaternion<f32>{
-                            {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z)
-                                 .ToFloat32()},
-                            get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
-                        }
-                            .Normalized();
-
-                    const Common::Vec3f view{
-                        get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
-                        get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
-                        get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
-                    };
-                    std::tie(primary_fragment_color, secondary_fragment_color) =
-                        ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
-                                               texture_color);
-                }
+        // Potentially switch to W-Buffer
+        if (regs.rasterizer.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering) {
+            // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+            depth *= interpolated_w_inverse.ToFloat32() * wsum;
+        }
 
-                // Write the TEV stages.
-                auto combiner_output =
-                    WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
-                                   secondary_fragment_color);
-
-                const auto& output_merger = regs.framebuffer.output_merger;
-                if (output_merger.fragment_operation_mode ==
-                    FramebufferRegs::FragmentOperationMode::Shadow) {
-                    const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
-                    // Use green color as the shadow intensity
-                    const u8 stencil = combiner_output.y;
-                    fb.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
-                    // Skip the normal output merger pipeline if it is in shadow mode
-                    continue;
-                }
+        // Clamp the result
+        depth = std::clamp(depth, 0.0f, 1.0f);
 
-                // Does alpha testing happen before or after stencil?
-                if (!DoAlphaTest(combiner_output.a())) {
-                    continue;
-                }
-                WriteFog(depth, combiner_output);
-                if (!DoDepthStencilTest(x, y, depth)) {
-                    continue;
+        /**
+         * Perspective correct attribute interpolation:
+         * Attribute values cannot be calculated by simple linear interpolation since
+         * they are not linear in screen space. For example, when interpolating a
+         * texture coordinate across two vertices, something simple like
+         *     u = (u0*w0 + u1*w1)/(w0+w1)
+         * will not work. However, the attribute value divided by the
+         * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
+         * in screenspace. Hence, we can linearly interpolate these two independently and
+         * calculate the interpolated attribute by dividing the results.
+         * I.e.
+         *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
+         *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
+         *     u = u_over_w / one_over_w
+         *
+         * The generalization to three vertices is straightforward in baricentric
+         *coordinates.
+         **/
+        const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
+            auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
+            f24 interpolated_attr_over_w = Common::Dot(attr_over_w, baricentric_coordinates);
+            return interpolated_attr_over_w * interpolated_w_inverse;
+        };
+
+        const Common::Vec4<u8> primary_color{
+            static_cast<u8>(round(
+                get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r()).ToFloat32() *
+                255)),
+            static_cast<u8>(round(
+                get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g()).ToFloat32() *
+                255)),
+            static_cast<u8>(round(
+                get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b()).ToFloat32() *
+                255)),
+            static_cast<u8>(round(
+                get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a()).ToFloat32() *
+                255)),
+        };
+
+        std::array<Common::Vec2<f24>, 3> uv;
+        uv[0].u() = get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
+        uv[0].v() = get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
+        uv[1].u() = get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
+        uv[1].v() = get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
+        uv[2].u() = get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
+        uv[2].v() = get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+
+        // Sample bound texture units.
+        const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+        const auto texture_color = TextureColor(uv, textures, tc0_w);
+
+        Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
+        Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
+
+        if (lighting && !regs.lighting.disable) {
+            const auto normquat =
+                Common::Quaternion<f32>{
+                    {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
+                     get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y).ToFloat32(),
+                     get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z).ToFloat32()},
+                    get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
                 }
-                const auto result = PixelColor(x, y, combiner_output);
-                if (regs.framebuffer.framebuffer.allow_color_write != 0) {
-                    fb.DrawPixel(x >> 4, y >> 4, result);
+                    .Normalized();
+
+            const Common::Vec3f view{
+                get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
+                get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
+                get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
+            };
+            std::tie(primary_fragment_color, secondary_fragment_color) =
+                ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view, texture_color);
+        }
+
+        // Write the TEV stages.
+        auto combiner_output =
+            WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
+                           secondary_fragment_color);
+
+        const auto& output_merger = regs.framebuffer.output_merger;
+        if (!Specialized && output_merger.fragment_operation_mode ==
+                                FramebufferRegs::FragmentOperationMode::Shadow) {
+            const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
+            // Use green color as the shadow intensity
+            const u8 stencil = combiner_output.y;
+            fb.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
+            // Skip the normal output merger pipeline if it is in shadow mode
+            return;
+        }
+
+        // Does alpha testing happen before or after stencil?
+        if constexpr (alpha_test) {
+            if (!DoAlphaTest(combiner_output.a())) {
+                return;
+            }
+        }
+        if constexpr (!Specialized) {
+            WriteFog(depth, combiner_output);
+        }
+        if constexpr (depth_stencil) {
+            if (!DoDepthStencilTest(x, y, depth)) {
+                return;
+            }
+        }
+        if constexpr (color_copy) {
+            // Blending and the logic op reduce to the combiner output, so the destination
+            // color is never read.
+            fb.DrawPixel(x >> 4, y >> 4, combiner_output);
+        } else {
+            const auto result = PixelColor(x, y, combiner_output);
+            if (Specialized || regs.framebuffer.framebuffer.allow_color_write != 0) {
+                fb.DrawPixel(x >> 4, y >> 4, result);
+            }
+        }
+    };
+
+    // Walk the bounding box in blocks, rejecting blocks that lie completely outside of an edge,
+    // and test the coverage of the remaining pixels one 2x2 quad at a time.
+    for (s32 block_y = y_begin; block_y < y_end; block_y += RASTER_BLOCK_SIZE) {
+        const s32 block_y_end = std::min(block_y + RASTER_BLOCK_SIZE, y_end);
+        for (s32 block_x = x_begin; block_x < x_end; block_x += RASTER_BLOCK_SIZE) {
+            const s32 block_x_end = std::min(block_x + RASTER_BLOCK_SIZE, x_end);
+            if (std::ranges::any_of(edges, [&](const EdgeFunction& edge) {
+                    return edge.IsBlockOutside(block_x, block_y, block_x_end - 1, block_y_end - 1);
+                })) {
+                continue;
+            }
+
+            for (s32 quad_y = block_y; quad_y < block_y_end; quad_y += 2) {
+                QuadEdges quad{edges, block_x, quad_y};
+                const u32 rows_mask = quad_y + 1 < block_y_end ? 0b1111 : 0b0011;
+                for (s32 quad_x = block_x; quad_x < block_x_end; quad_x += 2, quad.StepX()) {
+                    const u32 columns_mask = quad_x + 1 < block_x_end ? 0b1111 : 0b0101;
+                    const u32 mask = quad.CoverageMask() & rows_mask & columns_mask;
+                    if (mask == 0) {
+                        continue;
+                    }
+
+                    const auto values = quad.Values();
+                    for (u32 lane = 0; lane < 4; lane++) {
+                        if ((mask & (1U << lane)) == 0) {
+                            continue;
+                        }
+                        const u16 x = static_cast<u16>(((quad_x + (lane & 1)) << 4) + 8);
+                        const u16 y = static_cast<u16>(((quad_y + (lane >> 1)) << 4) + 8);
+                        shade_pixel(x, y, values[0][lane], values[1][lane], values[2][lane]);
+                    }
                 }
             }
-        };
-        sw_workers.QueueWork(std::move(process_scanline));
+        }
     }
-    sw_workers.WaitForRequests();
+
+    return num_fragments;
 }
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
@@ -557,11 +955,25 @@ std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
             t = texture.config.height - 1 -
                 GetWrappedTexCoord(texture.config.wrap_t, t, texture.config.height);
 
-            const u8* texture_data = memory.GetPhysicalPointer(texture_address);
-            const auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
+            // Cube maps select the face per pixel, the other units have a single texture.
+            const CachedTexture* cached = bound_textures[i];
+            if (i == 0 && !cached) {
+                for (const CachedTexture* face : bound_cube_faces) {
+                    if (face && face->address == texture_address) {
+                        cached = face;
+                        break;
+                    }
+                }
+            }
 
             // TODO: Apply the min and mag filters to the texture
-            texture_color[i] = LookupTexture(texture_data, s, t, info);
+            if (cached) {
+                texture_color[i] = cached->GetTexel(s, t);
+            } else {
+                const u8* texture_data = memory.GetPhysicalPointer(texture_address);
+                const auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
+                texture_color[i] = LookupTexture(texture_data, s, t, info);
+            }
         }
 
         if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -0,0 +1,116 @@
+// Copyright Citra Emulator Project / Azahar Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include "common/hash.h"
+#include "core/memory.h"
+#include "video_core/renderer_software/sw_texture_cache.h"
+
+namespace SwRenderer {
+
+using Pica::Texture::TextureInfo;
+
+namespace {
+
+/// Size of the decoded texel storage above which the cache is cleared before the next draw.
+constexpr std::size_t MAX_CACHED_SIZE = 64 * 1024 * 1024;
+
+u64 TextureKey(const TextureInfo& info) {
+    const std::array<u32, 4> key = {info.physical_address, info.width, info.height,
+                                     static_cast<u32>(info.format)};
+    return Common::ComputeStructHash64(key);
+}
+
+} // Anonymous namespace
+
+TextureCache::TextureCache(Memory::MemorySystem& memory_) : memory{memory_} {}
+
+TextureCache::~TextureCache() = default;
+
+void TextureCache::EvictIfFull() {
+    if (cached_size > MAX_CACHED_SIZE) {
+        Clear();
+    }
+}
+
+const CachedTexture* TextureCache::GetTexture(const TextureInfo& info) {
+    // Textures are made of whole 8x8 tiles, anything else is left to the uncached path.
+    if (info.width == 0 || info.height == 0 || info.width % 8 != 0 || info.height % 8 != 0 ||
+        info.stride <= 0) {
+        return nullptr;
+    }
+    // The last row of tiles only has to be as long as the texture is wide.
+    const std::size_t row_size = (info.width / 8) * Pica::Texture::CalculateTileSize(info.format);
+    const std::size_t size = static_cast<std::size_t>(info.stride) * (info.height / 8 - 1) +
+                             std::max<std::size_t>(info.stride, row_size);
+    const auto region = memory.GetPhysicalSpan(info.physical_address);
+    if (region.size() < size) {
+        return nullptr;
+    }
+    const u8* source = region.data();
+    const u64 hash = Common::ComputeHash64(source, size);
+
+    const u64 key = TextureKey(info);
+    if (const auto it = textures.find(key); it != textures.end()) {
+        CachedTexture& texture = it->second;
+        if (texture.hash != hash) {
+            texture.hash = hash;
+            Decode(texture, source, info);
+        }
+        return &texture;
+    }
+
+    cached_size += info.width * info.height * sizeof(Common::Vec4<u8>);
+
+    CachedTexture& texture = textures[key];
+    texture = {
+        .address = info.physical_address,
+        .width = info.width,
+        .height = info.height,
+        .format = info.format,
+        .size = static_cast<u32>(size),
+        .hash = hash,
+    };
+    Decode(texture, source, info);
+    return &texture;
+}
+
+void TextureCache::InvalidateRegion(PAddr addr, u32 size) {
+    const PAddr end = addr + size;
+    std::erase_if(textures, [&](const auto& entry) {
+        const CachedTexture& texture = entry.second;
+        if (texture.address >= end || texture.address + texture.size <= addr) {
+            return false;
+        }
+        cached_size -= texture.texels.size() * sizeof(Common::Vec4<u8>);
+        return true;
+    });
+}
+
+void TextureCache::Clear() {
+    textures.clear();
+    cached_size = 0;
+}
+
+void TextureCache::Decode(CachedTexture& texture, const u8* source, const TextureInfo& info) {
+    texture.texels.resize(info.width * info.height);
+
+    // Decode one 8x8 tile at a time to walk the source data linearly.
+    const std::size_t tile_size = Pica::Texture::CalculateTileSize(info.format);
+    for (u32 coarse_y = 0; coarse_y < info.height; coarse_y += 8) {
+        const u8* line = source + (coarse_y / 8) * info.stride;
+        for (u32 coarse_x = 0; coarse_x < info.width; coarse_x += 8) {
+            const u8* tile = line + (coarse_x / 8) * tile_size;
+            for (u32 y = 0; y < 8; y++) {
+                Common::Vec4<u8>* row = &texture.texels[(coarse_y + y) * info.width + coarse_x];
+                for (u32 x = 0; x < 8; x++) {
+                    row[x] = Pica::Texture::LookupTexelInTile(tile, x, y, info, false);
+                }
+            }
+        }
+    }
+}
+
+} // namespace SwRenderer
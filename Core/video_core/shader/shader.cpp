@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "common/arch.h"
+#include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader_interpreter.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 #include "video_core/shader/shader_jit.h"
@@ -11,6 +12,12 @@
 
 namespace Pica {
 
+void ShaderEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const {
+    for (ShaderUnit& state : states) {
+        Run(setup, state);
+    }
+}
+
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit) {
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
     if (use_jit) {
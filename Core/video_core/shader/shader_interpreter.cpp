@@ -3,13 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
 #include <numeric>
-#include <boost/circular_buffer.hpp>
+#include <optional>
+#include <span>
 #include <boost/container/static_vector.hpp>
 #include <nihstro/shader_bytecode.h>
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
@@ -18,6 +22,14 @@
 #include "video_core/pica_types.h"
 #include "video_core/shader/shader_interpreter.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define CITRA_HAS_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define CITRA_HAS_NEON
+#include <arm_neon.h>
+#endif
+
 using nihstro::Instruction;
 using nihstro::OpCode;
 using nihstro::RegisterType;
@@ -44,13 +56,132 @@ struct LoopStackElement {
     u8 previous_aL;
 };
 
+/// Fixed capacity scope stack that, like the hardware, overwrites its oldest entry when full.
+template <typename T, std::size_t Capacity>
+class ScopeStack {
+public:
+    bool empty() const {
+        return count == 0;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    T& back() {
+        return entries[(first + count - 1) % Capacity];
+    }
+
+    void push_back(const T& value) {
+        entries[(first + count) % Capacity] = value;
+        if (count == Capacity) {
+            first = (first + 1) % Capacity;
+        } else {
+            ++count;
+        }
+    }
+
+    void pop_back() {
+        --count;
+    }
+
+private:
+    std::array<T, Capacity> entries{};
+    std::size_t first{};
+    std::size_t count{};
+};
+
+/// Program counter and scope stacks of a shader invocation
+struct ControlState {
+    u32 program_counter{};
+    ScopeStack<IfStackElement, 8> if_stack;
+    ScopeStack<CallStackElement, 4> call_stack;
+    ScopeStack<LoopStackElement, 4> loop_stack;
+};
+
+static bool EvaluateCondition(Instruction::FlowControlType flow_control,
+                              const bool (&conditional_code)[2]) {
+    using Op = Instruction::FlowControlType::Op;
+
+    bool result_x = flow_control.refx.Value() == conditional_code[0];
+    bool result_y = flow_control.refy.Value() == conditional_code[1];
+
+    switch (flow_control.op) {
+    case Op::Or:
+        return result_x || result_y;
+    case Op::And:
+        return result_x && result_y;
+    case Op::JustX:
+        return result_x;
+    case Op::JustY:
+        return result_y;
+    default:
+        UNREACHABLE();
+        return false;
+    }
+}
+
+/**
+ * Closes the scopes ending with the instruction at old_program_counter. update_aL is invoked
+ * with the innermost loop when it is iterated or exited, and whether aL has to be restored to
+ * the value it had before the loop.
+ */
+template <typename UpdateLoopRegister>
+static void CloseScopes(ControlState& control, u32 old_program_counter, bool is_break,
+                        UpdateLoopRegister&& update_aL) {
+    auto& program_counter = control.program_counter;
+    auto& call_stack = control.call_stack;
+    auto& if_stack = control.if_stack;
+    auto& loop_stack = control.loop_stack;
+
+    // Stacks are checked in the order CALL -> IF -> LOOP. The CALL stack
+    // can be popped multiple times per instruction. A JMP at the end of a
+    // scope is never taken, this is why we compare against
+    // old_program_counter + 1 here.
+    u32 next_program_counter = old_program_counter + 1;
+    for (u32 i = 0; i < 4; i++) {
+        if (call_stack.empty() || call_stack.back().end_address != next_program_counter)
+            break;
+        // Hardware bug: when popping four CALL scopes at once, the last
+        // one doesn't update the program counter
+        if (i < 3) {
+            program_counter = call_stack.back().return_address;
+            next_program_counter = program_counter;
+        }
+        call_stack.pop_back();
+    }
+
+    // The other two stacks can only pop one entry per instruction. They
+    // are checked against the original program counter before any CALL
+    // scopes were closed and they overwrite any previous program counter
+    // updates.
+    if (!if_stack.empty() && if_stack.back().else_address == old_program_counter + 1) {
+        program_counter = if_stack.back().end_address;
+        if_stack.pop_back();
+    }
+
+    if (!loop_stack.empty() &&
+        (loop_stack.back().end_address == old_program_counter + 1 || is_break)) {
+        auto& loop = loop_stack.back();
+        if (!is_break && loop.loop_downcounter--) {
+            update_aL(loop, false);
+            program_counter = loop.entry_address;
+        } else {
+            // Only restore previous value if there is a surrounding LOOP scope.
+            update_aL(loop, loop_stack.size() > 1);
+            program_counter = loop.end_address;
+            loop_stack.pop_back();
+        }
+    }
+}
+
 template <bool Debug>
 static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
-                           DebugData<Debug>& debug_data, unsigned entry_point) {
-    boost::circular_buffer<IfStackElement> if_stack(8);
-    boost::circular_buffer<CallStackElement> call_stack(4);
-    boost::circular_buffer<LoopStackElement> loop_stack(4);
-    u32 program_counter = entry_point;
+                           DebugData<Debug>& debug_data, ControlState control) {
+    auto& if_stack = control.if_stack;
+    auto& call_stack = control.call_stack;
+    auto& loop_stack = control.loop_stack;
+    u32& program_counter = control.program_counter;
 
     const auto do_if = [&](Instruction instr, bool condition) {
         if (condition) {
@@ -84,24 +215,7 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
     };
 
     auto evaluate_condition = [&state](Instruction::FlowControlType flow_control) {
-        using Op = Instruction::FlowControlType::Op;
-
-        bool result_x = flow_control.refx.Value() == state.conditional_code[0];
-        bool result_y = flow_control.refy.Value() == state.conditional_code[1];
-
-        switch (flow_control.op) {
-        case Op::Or:
-            return result_x || result_y;
-        case Op::And:
-            return result_x && result_y;
-        case Op::JustX:
-            return result_x;
-        case Op::JustY:
-            return result_y;
-        default:
-            UNREACHABLE();
-            return false;
-        }
+        return EvaluateCondition(flow_control, state.conditional_code);
     };
 
     const auto& uniforms = setup.uniforms;
@@ -677,62 +791,1123 @@ static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
         ++program_counter;
         ++iteration;
 
-        // Stacks are checked in the order CALL -> IF -> LOOP. The CALL stack
-        // can be popped multiple times per instruction. A JMP at the end of a
-        // scope is never taken, this is why we compare against
-        // old_program_counter + 1 here.
-        u32 next_program_counter = old_program_counter + 1;
-        for (u32 i = 0; i < 4; i++) {
-            if (call_stack.empty() || call_stack.back().end_address != next_program_counter)
-                break;
-            // Hardware bug: when popping four CALL scopes at once, the last
-            // one doesn't update the program counter
-            if (i < 3) {
-                program_counter = call_stack.back().return_address;
-                next_program_counter = program_counter;
-            }
-            call_stack.pop_back();
-        }
-
-        // The other two stacks can only pop one entry per instruction. They
-        // are checked against the original program counter before any CALL
-        // scopes were closed and they overwrite any previous program counter
-        // updates.
-        if (!if_stack.empty() && if_stack.back().else_address == old_program_counter + 1) {
-            program_counter = if_stack.back().end_address;
-            if_stack.pop_back();
-        }
-
-        if (!loop_stack.empty() &&
-            (loop_stack.back().end_address == old_program_counter + 1 || is_break)) {
-            auto& loop = loop_stack.back();
-            state.address_registers[2] += loop.address_increment;
-            if (!is_break && loop.loop_downcounter--) {
-                program_counter = loop.entry_address;
-            } else {
-                program_counter = loop.end_address;
-                // Only restore previous value if there is a surrounding LOOP scope.
-                if (loop_stack.size() > 1)
-                    state.address_registers[2] = loop.previous_aL;
-                loop_stack.pop_back();
+        CloseScopes(control, old_program_counter, is_break,
+                    [&state](const LoopStackElement& loop, bool restore_previous) {
+                        state.address_registers[2] += loop.address_increment;
+                        if (restore_previous) {
+                            state.address_registers[2] = loop.previous_aL;
+                        }
+                    });
+    }
+}
+
+/// Number of invocations executed in lockstep by the batched interpreter
+constexpr std::size_t LANES = 4;
+
+/// Source operand with its register lookup and swizzle resolved
+struct DecodedSource {
+    RegisterType type;
+    u8 index;
+    u8 address_register_index;
+    bool negate;
+    std::array<u8, 4> selector;
+};
+
+struct ScalarContext;
+struct DecodedInstruction;
+
+using InstructionHandler = void (*)(ScalarContext& ctx, const DecodedInstruction& op);
+
+/// Instruction with its operands, handler and branch targets resolved ahead of execution
+struct DecodedInstruction {
+    Instruction instr;
+    InstructionHandler handler;
+    OpCode::Id opcode;
+    OpCode::Type type;
+    bool dest_is_output;
+    u8 dest_index;
+    u8 dest_mask;
+    std::array<DecodedSource, 3> src;
+    u32 flow_target;
+    u32 flow_end;
+};
+
+struct DecodedProgram {
+    std::array<DecodedInstruction, MAX_PROGRAM_CODE_LENGTH> code;
+};
+
+static DecodedSource DecodeSource(const SourceRegister& source_reg, int address_register_index,
+                                  bool negate, std::array<u8, 4> selector) {
+    return {
+        .type = source_reg.GetRegisterType(),
+        .index = static_cast<u8>(source_reg.GetIndex()),
+        .address_register_index = static_cast<u8>(address_register_index),
+        .negate = negate,
+        .selector = selector,
+    };
+}
+
+/// State of a scalar invocation running a decoded program
+struct ScalarContext {
+    const ShaderSetup& setup;
+    ShaderUnit& state;
+    ControlState& control;
+    bool is_break{};
+    bool should_stop{};
+};
+
+static void LoadSource(const ScalarContext& ctx, const DecodedSource& source, f24 (&out)[4]) {
+    // Constants for handling invalid inputs
+    static const f24 dummy_vec4_float24_zeros[4] = {f24::Zero(), f24::Zero(), f24::Zero(),
+                                                    f24::Zero()};
+    static const f24 dummy_vec4_float24_ones[4] = {f24::One(), f24::One(), f24::One(),
+                                                   f24::One()};
+
+    const f24* reg = dummy_vec4_float24_zeros;
+    switch (source.type) {
+    case RegisterType::Input:
+        reg = &ctx.state.input[source.index].x;
+        break;
+    case RegisterType::Temporary:
+        reg = &ctx.state.temporary[source.index].x;
+        break;
+    case RegisterType::FloatUniform: {
+        int index = source.index;
+        if (source.address_register_index != 0) {
+            int offset = ctx.state.address_registers[source.address_register_index - 1];
+            if (offset < std::numeric_limits<s8>::min() ||
+                offset > std::numeric_limits<s8>::max()) [[unlikely]] {
+                offset = 0;
+            }
+            index = (index + offset) & 0x7F;
+        }
+        // If the index is above 96, the result is all one.
+        reg = index >= 96 ? dummy_vec4_float24_ones : &ctx.setup.uniforms.f[index].x;
+        break;
+    }
+    default:
+        break;
+    }
+
+    for (std::size_t i = 0; i < 4; ++i) {
+        out[i] = source.negate ? -reg[source.selector[i]] : reg[source.selector[i]];
+    }
+}
+
+static void StoreDest(ScalarContext& ctx, const DecodedInstruction& op, const f24 (&value)[4]) {
+    f24* dest = op.dest_is_output ? &ctx.state.output[op.dest_index][0]
+                                  : &ctx.state.temporary[op.dest_index][0];
+    for (std::size_t i = 0; i < 4; ++i) {
+        if (op.dest_mask & (1 << i)) {
+            dest[i] = value[i];
+        }
+    }
+}
+
+template <OpCode::Id Opcode>
+static void HandleArithmetic(ScalarContext& ctx, const DecodedInstruction& op) {
+    f24 src1[4];
+    f24 src2[4];
+    f24 result[4];
+    LoadSource(ctx, op.src[0], src1);
+    LoadSource(ctx, op.src[1], src2);
+
+    if constexpr (Opcode == OpCode::Id::ADD) {
+        for (int i = 0; i < 4; ++i) {
+            result[i] = src1[i] + src2[i];
+        }
+    } else if constexpr (Opcode == OpCode::Id::MUL) {
+        for (int i = 0; i < 4; ++i) {
+            result[i] = src1[i] * src2[i];
+        }
+    } else if constexpr (Opcode == OpCode::Id::FLR) {
+        for (int i = 0; i < 4; ++i) {
+            result[i] = f24::FromFloat32(std::floor(src1[i].ToFloat32()));
+        }
+    } else if constexpr (Opcode == OpCode::Id::MAX) {
+        for (int i = 0; i < 4; ++i) {
+            result[i] = (src1[i] > src2[i]) ? src1[i] : src2[i];
+        }
+    } else if constexpr (Opcode == OpCode::Id::MIN) {
+        for (int i = 0; i < 4; ++i) {
+            result[i] = (src1[i] < src2[i]) ? src1[i] : src2[i];
+        }
+    } else if constexpr (Opcode == OpCode::Id::DP3 || Opcode == OpCode::Id::DP4 ||
+                         Opcode == OpCode::Id::DPH || Opcode == OpCode::Id::DPHI) {
+        if constexpr (Opcode == OpCode::Id::DPH || Opcode == OpCode::Id::DPHI) {
+            src1[3] = f24::One();
+        }
+        constexpr int num_components = (Opcode == OpCode::Id::DP3) ? 3 : 4;
+        const f24 dot = std::inner_product(src1, src1 + num_components, src2, f24::Zero());
+        std::fill(std::begin(result), std::end(result), dot);
+    } else if constexpr (Opcode == OpCode::Id::RCP) {
+        std::fill(std::begin(result), std::end(result),
+                  f24::FromFloat32(1.0f / src1[0].ToFloat32()));
+    } else if constexpr (Opcode == OpCode::Id::RSQ) {
+        std::fill(std::begin(result), std::end(result),
+                  f24::FromFloat32(1.0f / std::sqrt(src1[0].ToFloat32())));
+    } else if constexpr (Opcode == OpCode::Id::EX2) {
+        std::fill(std::begin(result), std::end(result),
+                  f24::FromFloat32(std::exp2(src1[0].ToFloat32())));
+    } else if constexpr (Opcode == OpCode::Id::LG2) {
+        std::fill(std::begin(result), std::end(result),
+                  f24::FromFloat32(std::log2(src1[0].ToFloat32())));
+    } else if constexpr (Opcode == OpCode::Id::MOV) {
+        std::copy(std::begin(src1), std::end(src1), result);
+    } else if constexpr (Opcode == OpCode::Id::SGE || Opcode == OpCode::Id::SGEI) {
+        for (int i = 0; i < 4; ++i) {
+            result[i] = (src1[i] >= src2[i]) ? f24::One() : f24::Zero();
+        }
+    } else if constexpr (Opcode == OpCode::Id::SLT || Opcode == OpCode::Id::SLTI) {
+        for (int i = 0; i < 4; ++i) {
+            result[i] = (src1[i] < src2[i]) ? f24::One() : f24::Zero();
+        }
+    } else if constexpr (Opcode == OpCode::Id::MOVA) {
+        for (int i = 0; i < 2; ++i) {
+            if (op.dest_mask & (1 << i)) {
+                // TODO: Figure out how the rounding is done on hardware
+                ctx.state.address_registers[i] = static_cast<s32>(src1[i].ToFloat32());
+            }
+        }
+        return;
+    } else if constexpr (Opcode == OpCode::Id::CMP) {
+        using CompareOp = Instruction::Common::CompareOpType;
+        for (int i = 0; i < 2; ++i) {
+            const auto compare_op = op.instr.common.compare_op;
+            const auto cmp = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+            bool& code = ctx.state.conditional_code[i];
+            switch (cmp) {
+            case CompareOp::Equal:
+                code = src1[i] == src2[i];
+                break;
+            case CompareOp::NotEqual:
+                code = src1[i] != src2[i];
+                break;
+            case CompareOp::LessThan:
+                code = src1[i] < src2[i];
+                break;
+            case CompareOp::LessEqual:
+                code = src1[i] <= src2[i];
+                break;
+            case CompareOp::GreaterThan:
+                code = src1[i] > src2[i];
+                break;
+            case CompareOp::GreaterEqual:
+                code = src1[i] >= src2[i];
+                break;
+            default:
+                LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", static_cast<int>(cmp));
+                break;
+            }
+        }
+        return;
+    } else if constexpr (Opcode == OpCode::Id::MAD || Opcode == OpCode::Id::MADI) {
+        f24 src3[4];
+        LoadSource(ctx, op.src[2], src3);
+        for (int i = 0; i < 4; ++i) {
+            result[i] = src1[i] * src2[i] + src3[i];
+        }
+    } else {
+        static_assert(Opcode != Opcode, "Unhandled arithmetic opcode");
+    }
+
+    StoreDest(ctx, op, result);
+}
+
+static void HandleUnknown(ScalarContext&, const DecodedInstruction& op) {
+    const Instruction instr = op.instr;
+    LOG_ERROR(HW_GPU, "Unhandled instruction: 0x{:02x} ({}): 0x{:08x}",
+              (int)instr.opcode.Value().EffectiveOpCode(), instr.opcode.Value().GetInfo().name,
+              instr.hex);
+}
+
+static void HandleEnd(ScalarContext& ctx, const DecodedInstruction&) {
+    ctx.should_stop = true;
+}
+
+static void HandleNop(ScalarContext&, const DecodedInstruction&) {}
+
+static void DoCall(ScalarContext& ctx, const DecodedInstruction& op) {
+    auto& program_counter = ctx.control.program_counter;
+    ctx.control.call_stack.push_back({
+        .end_address = op.flow_end,
+        .return_address = program_counter + 1,
+    });
+    program_counter = op.flow_target - 1;
+}
+
+static void DoIf(ScalarContext& ctx, const DecodedInstruction& op, bool condition) {
+    if (condition) {
+        ctx.control.if_stack.push_back({
+            .else_address = op.flow_target,
+            .end_address = op.flow_end,
+        });
+    } else {
+        ctx.control.program_counter = op.flow_target - 1;
+    }
+}
+
+static bool UniformCondition(const ScalarContext& ctx, const DecodedInstruction& op) {
+    return ctx.setup.uniforms.b[op.instr.flow_control.bool_uniform_id];
+}
+
+static bool CodeCondition(const ScalarContext& ctx, const DecodedInstruction& op) {
+    return EvaluateCondition(op.instr.flow_control, ctx.state.conditional_code);
+}
+
+static void HandleJmpc(ScalarContext& ctx, const DecodedInstruction& op) {
+    if (CodeCondition(ctx, op)) {
+        ctx.control.program_counter = op.flow_target - 1;
+    }
+}
+
+static void HandleJmpu(ScalarContext& ctx, const DecodedInstruction& op) {
+    if (UniformCondition(ctx, op) == !(op.instr.flow_control.num_instructions & 1)) {
+        ctx.control.program_counter = op.flow_target - 1;
+    }
+}
+
+static void HandleCall(ScalarContext& ctx, const DecodedInstruction& op) {
+    DoCall(ctx, op);
+}
+
+static void HandleCallu(ScalarContext& ctx, const DecodedInstruction& op) {
+    if (UniformCondition(ctx, op)) {
+        DoCall(ctx, op);
+    }
+}
+
+static void HandleCallc(ScalarContext& ctx, const DecodedInstruction& op) {
+    if (CodeCondition(ctx, op)) {
+        DoCall(ctx, op);
+    }
+}
+
+static void HandleIfu(ScalarContext& ctx, const DecodedInstruction& op) {
+    DoIf(ctx, op, UniformCondition(ctx, op));
+}
+
+static void HandleIfc(ScalarContext& ctx, const DecodedInstruction& op) {
+    DoIf(ctx, op, CodeCondition(ctx, op));
+}
+
+static void HandleLoop(ScalarContext& ctx, const DecodedInstruction& op) {
+    const Common::Vec4<u8>& loop_param =
+        ctx.setup.uniforms.i[op.instr.flow_control.int_uniform_id];
+    // aL is set to the start value before it is saved, matching the reference interpreter.
+    ctx.state.address_registers[2] = loop_param.y;
+    ctx.control.loop_stack.push_back({
+        .entry_address = ctx.control.program_counter + 1,
+        .end_address = op.flow_target + 1,
+        .loop_downcounter = loop_param.x,
+        .address_increment = loop_param.z,
+        .previous_aL = loop_param.y,
+    });
+}
+
+static void HandleBreak(ScalarContext& ctx, const DecodedInstruction&) {
+    ctx.is_break = true;
+}
+
+static void HandleBreakc(ScalarContext& ctx, const DecodedInstruction& op) {
+    ctx.is_break = CodeCondition(ctx, op);
+}
+
+static void HandleEmit(ScalarContext& ctx, const DecodedInstruction&) {
+    auto* emitter = ctx.state.emitter_ptr;
+    ASSERT_MSG(emitter, "Execute EMIT on VS");
+    emitter->Emit(ctx.state.output);
+}
+
+static void HandleSetEmit(ScalarContext& ctx, const DecodedInstruction& op) {
+    auto* emitter = ctx.state.emitter_ptr;
+    ASSERT_MSG(emitter, "Execute SETEMIT on VS");
+    emitter->vertex_id = op.instr.setemit.vertex_id;
+    emitter->prim_emit = op.instr.setemit.prim_emit != 0;
+    emitter->winding = op.instr.setemit.winding != 0;
+}
+
+static InstructionHandler SelectHandler(const DecodedInstruction& op) {
+    switch (op.type) {
+    case OpCode::Type::Arithmetic:
+    case OpCode::Type::MultiplyAdd:
+        switch (op.opcode) {
+#define ARITHMETIC_HANDLER(name)                                                                   \
+    case OpCode::Id::name:                                                                         \
+        return &HandleArithmetic<OpCode::Id::name>;
+            ARITHMETIC_HANDLER(ADD)
+            ARITHMETIC_HANDLER(MUL)
+            ARITHMETIC_HANDLER(FLR)
+            ARITHMETIC_HANDLER(MAX)
+            ARITHMETIC_HANDLER(MIN)
+            ARITHMETIC_HANDLER(DP3)
+            ARITHMETIC_HANDLER(DP4)
+            ARITHMETIC_HANDLER(DPH)
+            ARITHMETIC_HANDLER(DPHI)
+            ARITHMETIC_HANDLER(RCP)
+            ARITHMETIC_HANDLER(RSQ)
+            ARITHMETIC_HANDLER(EX2)
+            ARITHMETIC_HANDLER(LG2)
+            ARITHMETIC_HANDLER(MOV)
+            ARITHMETIC_HANDLER(SGE)
+            ARITHMETIC_HANDLER(SGEI)
+            ARITHMETIC_HANDLER(SLT)
+            ARITHMETIC_HANDLER(SLTI)
+            ARITHMETIC_HANDLER(MOVA)
+            ARITHMETIC_HANDLER(CMP)
+            ARITHMETIC_HANDLER(MAD)
+            ARITHMETIC_HANDLER(MADI)
+#undef ARITHMETIC_HANDLER
+        default:
+            return &HandleUnknown;
+        }
+    default:
+        break;
+    }
+
+    switch (op.opcode) {
+    case OpCode::Id::END:
+        return &HandleEnd;
+    case OpCode::Id::NOP:
+        return &HandleNop;
+    case OpCode::Id::JMPC:
+        return &HandleJmpc;
+    case OpCode::Id::JMPU:
+        return &HandleJmpu;
+    case OpCode::Id::CALL:
+        return &HandleCall;
+    case OpCode::Id::CALLU:
+        return &HandleCallu;
+    case OpCode::Id::CALLC:
+        return &HandleCallc;
+    case OpCode::Id::IFU:
+        return &HandleIfu;
+    case OpCode::Id::IFC:
+        return &HandleIfc;
+    case OpCode::Id::LOOP:
+        return &HandleLoop;
+    case OpCode::Id::BREAK:
+        return &HandleBreak;
+    case OpCode::Id::BREAKC:
+        return &HandleBreakc;
+    case OpCode::Id::EMIT:
+        return &HandleEmit;
+    case OpCode::Id::SETEMIT:
+        return &HandleSetEmit;
+    default:
+        return &HandleUnknown;
+    }
+}
+
+static void DecodeProgram(const ShaderSetup& setup, DecodedProgram& program) {
+    for (u32 offset = 0; offset < MAX_PROGRAM_CODE_LENGTH; ++offset) {
+        const Instruction instr = {setup.program_code[offset]};
+        auto& op = program.code[offset];
+        op = {};
+        op.instr = instr;
+        op.opcode = instr.opcode.Value();
+        op.type = instr.opcode.Value().GetInfo().type;
+        op.flow_target = instr.flow_control.dest_offset;
+        op.flow_end = instr.flow_control.dest_offset + instr.flow_control.num_instructions;
+
+        if (op.type == OpCode::Type::Arithmetic) {
+            const SwizzlePattern swizzle = {setup.swizzle_data[instr.common.operand_desc_id]};
+            const bool is_inverted =
+                (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+            op.opcode = instr.opcode.Value().EffectiveOpCode();
+            op.src[0] = DecodeSource(instr.common.GetSrc1(is_inverted),
+                                     !is_inverted * instr.common.address_register_index,
+                                     swizzle.negate_src1.Value() != 0,
+                                     {
+                                         static_cast<u8>(swizzle.src1_selector_0.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_1.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_2.Value()),
+                                         static_cast<u8>(swizzle.src1_selector_3.Value()),
+                                     });
+            op.src[1] = DecodeSource(instr.common.GetSrc2(is_inverted),
+                                     is_inverted * instr.common.address_register_index,
+                                     swizzle.negate_src2.Value() != 0,
+                                     {
+                                         static_cast<u8>(swizzle.src2_selector_0.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_1.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_2.Value()),
+                                         static_cast<u8>(swizzle.src2_selector_3.Value()),
+                                     });
+            op.dest_is_output = instr.common.dest.Value() < 0x10;
+            op.dest_index = static_cast<u8>(instr.common.dest.Value().GetIndex());
+            // Writes to registers past the temporaries are discarded
+            if (instr.common.dest.Value() < 0x20) {
+                for (int i = 0; i < 4; ++i) {
+                    op.dest_mask |= swizzle.DestComponentEnabled(i) << i;
+                }
+            }
+        } else if (op.type == OpCode::Type::MultiplyAdd) {
+            op.opcode = instr.opcode.Value().EffectiveOpCode();
+        }
+
+        if (op.opcode == OpCode::Id::MAD || op.opcode == OpCode::Id::MADI) {
+            const SwizzlePattern mad_swizzle = {setup.swizzle_data[instr.mad.operand_desc_id]};
+            const bool is_inverted = op.opcode == OpCode::Id::MADI;
+
+            op.src[0] = DecodeSource(instr.mad.GetSrc1(is_inverted), 0,
+                                     mad_swizzle.negate_src1.Value() != 0,
+                                     {
+                                         static_cast<u8>(mad_swizzle.src1_selector_0.Value()),
+                                         static_cast<u8>(mad_swizzle.src1_selector_1.Value()),
+                                         static_cast<u8>(mad_swizzle.src1_selector_2.Value()),
+                                         static_cast<u8>(mad_swizzle.src1_selector_3.Value()),
+                                     });
+            op.src[1] = DecodeSource(instr.mad.GetSrc2(is_inverted),
+                                     !is_inverted * instr.mad.address_register_index,
+                                     mad_swizzle.negate_src2.Value() != 0,
+                                     {
+                                         static_cast<u8>(mad_swizzle.src2_selector_0.Value()),
+                                         static_cast<u8>(mad_swizzle.src2_selector_1.Value()),
+                                         static_cast<u8>(mad_swizzle.src2_selector_2.Value()),
+                                         static_cast<u8>(mad_swizzle.src2_selector_3.Value()),
+                                     });
+            op.src[2] = DecodeSource(instr.mad.GetSrc3(is_inverted),
+                                     is_inverted * instr.mad.address_register_index,
+                                     mad_swizzle.negate_src3.Value() != 0,
+                                     {
+                                         static_cast<u8>(mad_swizzle.src3_selector_0.Value()),
+                                         static_cast<u8>(mad_swizzle.src3_selector_1.Value()),
+                                         static_cast<u8>(mad_swizzle.src3_selector_2.Value()),
+                                         static_cast<u8>(mad_swizzle.src3_selector_3.Value()),
+                                     });
+            op.dest_is_output = instr.mad.dest.Value() < 0x10;
+            op.dest_index = static_cast<u8>(instr.mad.dest.Value().GetIndex());
+            // Writes to registers past the temporaries are discarded
+            if (instr.mad.dest.Value() < 0x20) {
+                for (int i = 0; i < 4; ++i) {
+                    op.dest_mask |= mad_swizzle.DestComponentEnabled(i) << i;
+                }
             }
         }
+
+        op.handler = SelectHandler(op);
+    }
+}
+
+/// Runs a decoded program by dispatching through the handler of each instruction
+static void RunDecodedInterpreter(const ShaderSetup& setup, const DecodedProgram& program,
+                                  ShaderUnit& state, ControlState control) {
+    ScalarContext ctx{.setup = setup, .state = state, .control = control};
+    while (!ctx.should_stop) {
+        ctx.is_break = false;
+        const u32 old_program_counter = control.program_counter;
+        const DecodedInstruction& op = program.code[old_program_counter];
+        op.handler(ctx, op);
+
+        ++control.program_counter;
+
+        CloseScopes(control, old_program_counter, ctx.is_break,
+                    [&state](const LoopStackElement& loop, bool restore_previous) {
+                        state.address_registers[2] += loop.address_increment;
+                        if (restore_previous) {
+                            state.address_registers[2] = loop.previous_aL;
+                        }
+                    });
+    }
+}
+
+/// One register component across all lanes of a batch
+struct alignas(16) Lanes {
+    float v[LANES];
+
+    static Lanes Broadcast(float value) {
+        Lanes result;
+        std::fill(std::begin(result.v), std::end(result.v), value);
+        return result;
+    }
+};
+
+using LaneVec4 = std::array<Lanes, 4>;
+
+static Lanes LanesAdd(const Lanes& a, const Lanes& b) {
+    Lanes result;
+#if defined(CITRA_HAS_SSE2)
+    _mm_store_ps(result.v, _mm_add_ps(_mm_load_ps(a.v), _mm_load_ps(b.v)));
+#elif defined(CITRA_HAS_NEON)
+    vst1q_f32(result.v, vaddq_f32(vld1q_f32(a.v), vld1q_f32(b.v)));
+#else
+    for (std::size_t l = 0; l < LANES; ++l) {
+        result.v[l] = a.v[l] + b.v[l];
+    }
+#endif
+    return result;
+}
+
+/// Multiplication with the PICA rule of returning 0 instead of NaN for 0 * inf
+static Lanes LanesMul(const Lanes& a, const Lanes& b) {
+    Lanes result;
+#if defined(CITRA_HAS_SSE2)
+    const __m128 x = _mm_load_ps(a.v);
+    const __m128 y = _mm_load_ps(b.v);
+    const __m128 product = _mm_mul_ps(x, y);
+    const __m128 zero_mask = _mm_and_ps(_mm_cmpunord_ps(product, product), _mm_cmpord_ps(x, y));
+    _mm_store_ps(result.v, _mm_andnot_ps(zero_mask, product));
+#elif defined(CITRA_HAS_NEON)
+    const float32x4_t x = vld1q_f32(a.v);
+    const float32x4_t y = vld1q_f32(b.v);
+    const float32x4_t product = vmulq_f32(x, y);
+    const uint32x4_t ordered = vandq_u32(vceqq_f32(x, x), vceqq_f32(y, y));
+    const uint32x4_t zero_mask = vandq_u32(vmvnq_u32(vceqq_f32(product, product)), ordered);
+    vst1q_f32(result.v,
+              vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(product), zero_mask)));
+#else
+    for (std::size_t l = 0; l < LANES; ++l) {
+        result.v[l] = (f24::FromFloat32(a.v[l]) * f24::FromFloat32(b.v[l])).ToFloat32();
+    }
+#endif
+    return result;
+}
+
+/// Returns a > b ? a : b, which gives max(0, NaN) -> NaN and max(NaN, 0) -> 0 like hardware
+static Lanes LanesMax(const Lanes& a, const Lanes& b) {
+    Lanes result;
+#if defined(CITRA_HAS_SSE2)
+    _mm_store_ps(result.v, _mm_max_ps(_mm_load_ps(a.v), _mm_load_ps(b.v)));
+#elif defined(CITRA_HAS_NEON)
+    const float32x4_t x = vld1q_f32(a.v);
+    const float32x4_t y = vld1q_f32(b.v);
+    vst1q_f32(result.v, vbslq_f32(vcgtq_f32(x, y), x, y));
+#else
+    for (std::size_t l = 0; l < LANES; ++l) {
+        result.v[l] = (a.v[l] > b.v[l]) ? a.v[l] : b.v[l];
+    }
+#endif
+    return result;
+}
+
+/// Returns a < b ? a : b, which gives min(0, NaN) -> NaN and min(NaN, 0) -> 0 like hardware
+static Lanes LanesMin(const Lanes& a, const Lanes& b) {
+    Lanes result;
+#if defined(CITRA_HAS_SSE2)
+    _mm_store_ps(result.v, _mm_min_ps(_mm_load_ps(a.v), _mm_load_ps(b.v)));
+#elif defined(CITRA_HAS_NEON)
+    const float32x4_t x = vld1q_f32(a.v);
+    const float32x4_t y = vld1q_f32(b.v);
+    vst1q_f32(result.v, vbslq_f32(vcltq_f32(x, y), x, y));
+#else
+    for (std::size_t l = 0; l < LANES; ++l) {
+        result.v[l] = (a.v[l] < b.v[l]) ? a.v[l] : b.v[l];
+    }
+#endif
+    return result;
+}
+
+/// Per lane a >= b ? 1 : 0
+static Lanes LanesSge(const Lanes& a, const Lanes& b) {
+    Lanes result;
+#if defined(CITRA_HAS_SSE2)
+    const __m128 mask = _mm_cmpge_ps(_mm_load_ps(a.v), _mm_load_ps(b.v));
+    _mm_store_ps(result.v, _mm_and_ps(mask, _mm_set1_ps(1.0f)));
+#elif defined(CITRA_HAS_NEON)
+    const uint32x4_t mask = vcgeq_f32(vld1q_f32(a.v), vld1q_f32(b.v));
+    vst1q_f32(result.v, vreinterpretq_f32_u32(
+                            vandq_u32(mask, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+#else
+    for (std::size_t l = 0; l < LANES; ++l) {
+        result.v[l] = (a.v[l] >= b.v[l]) ? 1.0f : 0.0f;
     }
+#endif
+    return result;
 }
 
+/// Per lane a < b ? 1 : 0
+static Lanes LanesSlt(const Lanes& a, const Lanes& b) {
+    Lanes result;
+#if defined(CITRA_HAS_SSE2)
+    const __m128 mask = _mm_cmplt_ps(_mm_load_ps(a.v), _mm_load_ps(b.v));
+    _mm_store_ps(result.v, _mm_and_ps(mask, _mm_set1_ps(1.0f)));
+#elif defined(CITRA_HAS_NEON)
+    const uint32x4_t mask = vcltq_f32(vld1q_f32(a.v), vld1q_f32(b.v));
+    vst1q_f32(result.v, vreinterpretq_f32_u32(
+                            vandq_u32(mask, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+#else
+    for (std::size_t l = 0; l < LANES; ++l) {
+        result.v[l] = (a.v[l] < b.v[l]) ? 1.0f : 0.0f;
+    }
+#endif
+    return result;
+}
+
+template <typename Func>
+static Lanes LanesMap(const Lanes& a, Func&& func) {
+    Lanes result;
+    for (std::size_t l = 0; l < LANES; ++l) {
+        result.v[l] = func(a.v[l]);
+    }
+    return result;
+}
+
+/// Register file of a batch in structure-of-arrays layout
+struct BatchState {
+    std::array<LaneVec4, 16> input;
+    std::array<LaneVec4, 16> temporary;
+    std::array<LaneVec4, 16> output;
+    std::array<std::array<s32, LANES>, 3> address_registers;
+    std::array<std::array<bool, LANES>, 2> conditional_code;
+
+    void Load(std::span<const ShaderUnit, LANES> units) {
+        for (std::size_t l = 0; l < LANES; ++l) {
+            const ShaderUnit& unit = units[l];
+            for (std::size_t reg = 0; reg < 16; ++reg) {
+                for (std::size_t comp = 0; comp < 4; ++comp) {
+                    input[reg][comp].v[l] = unit.input[reg][comp].ToFloat32();
+                    temporary[reg][comp].v[l] = unit.temporary[reg][comp].ToFloat32();
+                    output[reg][comp].v[l] = unit.output[reg][comp].ToFloat32();
+                }
+            }
+            for (std::size_t i = 0; i < 3; ++i) {
+                address_registers[i][l] = unit.address_registers[i];
+            }
+            conditional_code[0][l] = unit.conditional_code[0];
+            conditional_code[1][l] = unit.conditional_code[1];
+        }
+    }
+
+    void Store(std::span<ShaderUnit, LANES> units) const {
+        for (std::size_t l = 0; l < LANES; ++l) {
+            ShaderUnit& unit = units[l];
+            for (std::size_t reg = 0; reg < 16; ++reg) {
+                for (std::size_t comp = 0; comp < 4; ++comp) {
+                    unit.temporary[reg][comp] = f24::FromFloat32(temporary[reg][comp].v[l]);
+                    unit.output[reg][comp] = f24::FromFloat32(output[reg][comp].v[l]);
+                }
+            }
+            for (std::size_t i = 0; i < 3; ++i) {
+                unit.address_registers[i] = address_registers[i][l];
+            }
+            unit.conditional_code[0] = conditional_code[0][l];
+            unit.conditional_code[1] = conditional_code[1][l];
+        }
+    }
+};
+
+static LaneVec4 FetchSource(const Uniforms& uniforms, const BatchState& state,
+                            const DecodedSource& source) {
+    LaneVec4 result;
+    switch (source.type) {
+    case RegisterType::Input:
+    case RegisterType::Temporary: {
+        const LaneVec4& reg = source.type == RegisterType::Input ? state.input[source.index]
+                                                                 : state.temporary[source.index];
+        for (std::size_t i = 0; i < 4; ++i) {
+            result[i] = reg[source.selector[i]];
+        }
+        break;
+    }
+    case RegisterType::FloatUniform:
+        if (source.address_register_index == 0) {
+            const auto& uniform = uniforms.f[source.index];
+            for (std::size_t i = 0; i < 4; ++i) {
+                result[i] = Lanes::Broadcast(uniform[source.selector[i]].ToFloat32());
+            }
+            break;
+        }
+        // Relative addressing can pick a different uniform for each lane
+        for (std::size_t l = 0; l < LANES; ++l) {
+            int offset = state.address_registers[source.address_register_index - 1][l];
+            if (offset < std::numeric_limits<s8>::min() ||
+                offset > std::numeric_limits<s8>::max()) [[unlikely]] {
+                offset = 0;
+            }
+            const int index = (source.index + offset) & 0x7F;
+            for (std::size_t i = 0; i < 4; ++i) {
+                // If the index is above 96, the result is all one.
+                result[i].v[l] = index >= 96 ? 1.0f
+                                             : uniforms.f[index][source.selector[i]].ToFloat32();
+            }
+        }
+        break;
+    default:
+        result.fill(Lanes::Broadcast(0.0f));
+        break;
+    }
+
+    if (source.negate) {
+        for (auto& component : result) {
+            component = LanesMap(component, [](float x) { return -x; });
+        }
+    }
+    return result;
+}
+
+/// Evaluates a conditional flow control instruction, nullopt if the lanes disagree
+static std::optional<bool> EvaluateBatchCondition(Instruction::FlowControlType flow_control,
+                                                  const BatchState& state) {
+    std::optional<bool> result;
+    for (std::size_t l = 0; l < LANES; ++l) {
+        const bool conditional_code[2] = {state.conditional_code[0][l],
+                                          state.conditional_code[1][l]};
+        const bool lane_result = EvaluateCondition(flow_control, conditional_code);
+        if (result && *result != lane_result) {
+            return std::nullopt;
+        }
+        result = lane_result;
+    }
+    return result;
+}
+
+/**
+ * Runs LANES invocations of the decoded program in lockstep. Instructions are executed once
+ * per batch on SoA registers for as long as control flow is uniform across the lanes. When the
+ * lanes diverge, or an instruction without a batched implementation is reached, each lane
+ * finishes on the scalar interpreter from that instruction on.
+ */
+static void RunBatchInterpreter(const ShaderSetup& setup, const DecodedProgram& program,
+                                std::span<ShaderUnit, LANES> units) {
+    BatchState state;
+    state.Load(units);
+
+    const auto& uniforms = setup.uniforms;
+    ControlState control{.program_counter = setup.entry_point};
+    u32& program_counter = control.program_counter;
+
+    const auto finish_scalar = [&] {
+        state.Store(units);
+        for (ShaderUnit& unit : units) {
+            RunDecodedInterpreter(setup, program, unit, control);
+        }
+    };
+
+    while (true) {
+        bool is_break = false;
+        const u32 old_program_counter = program_counter;
+        const DecodedInstruction& op = program.code[program_counter];
+        const Instruction instr = op.instr;
+
+        if (op.type == OpCode::Type::Arithmetic || op.type == OpCode::Type::MultiplyAdd) {
+            const bool is_mad = op.type == OpCode::Type::MultiplyAdd;
+            if (is_mad && op.opcode != OpCode::Id::MAD && op.opcode != OpCode::Id::MADI) {
+                finish_scalar();
+                return;
+            }
+
+            LaneVec4 src1 = FetchSource(uniforms, state, op.src[0]);
+            const LaneVec4 src2 = FetchSource(uniforms, state, op.src[1]);
+            LaneVec4 result;
+
+            switch (op.opcode) {
+            case OpCode::Id::MAD:
+            case OpCode::Id::MADI: {
+                const LaneVec4 src3 = FetchSource(uniforms, state, op.src[2]);
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesAdd(LanesMul(src1[i], src2[i]), src3[i]);
+                }
+                break;
+            }
+            case OpCode::Id::ADD:
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesAdd(src1[i], src2[i]);
+                }
+                break;
+            case OpCode::Id::MUL:
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesMul(src1[i], src2[i]);
+                }
+                break;
+            case OpCode::Id::FLR:
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesMap(src1[i], [](float x) { return std::floor(x); });
+                }
+                break;
+            case OpCode::Id::MAX:
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesMax(src1[i], src2[i]);
+                }
+                break;
+            case OpCode::Id::MIN:
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesMin(src1[i], src2[i]);
+                }
+                break;
+            case OpCode::Id::DP3:
+            case OpCode::Id::DP4:
+            case OpCode::Id::DPH:
+            case OpCode::Id::DPHI: {
+                if (op.opcode == OpCode::Id::DPH || op.opcode == OpCode::Id::DPHI) {
+                    src1[3] = Lanes::Broadcast(1.0f);
+                }
+
+                const std::size_t num_components = (op.opcode == OpCode::Id::DP3) ? 3 : 4;
+                Lanes dot = Lanes::Broadcast(0.0f);
+                for (std::size_t i = 0; i < num_components; ++i) {
+                    dot = LanesAdd(dot, LanesMul(src1[i], src2[i]));
+                }
+                result.fill(dot);
+                break;
+            }
+            case OpCode::Id::RCP:
+                result.fill(LanesMap(src1[0], [](float x) { return 1.0f / x; }));
+                break;
+            case OpCode::Id::RSQ:
+                result.fill(LanesMap(src1[0], [](float x) { return 1.0f / std::sqrt(x); }));
+                break;
+            case OpCode::Id::EX2:
+                result.fill(LanesMap(src1[0], [](float x) { return std::exp2(x); }));
+                break;
+            case OpCode::Id::LG2:
+                result.fill(LanesMap(src1[0], [](float x) { return std::log2(x); }));
+                break;
+            case OpCode::Id::MOV:
+                result = src1;
+                break;
+            case OpCode::Id::SGE:
+            case OpCode::Id::SGEI:
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesSge(src1[i], src2[i]);
+                }
+                break;
+            case OpCode::Id::SLT:
+            case OpCode::Id::SLTI:
+                for (std::size_t i = 0; i < 4; ++i) {
+                    result[i] = LanesSlt(src1[i], src2[i]);
+                }
+                break;
+            case OpCode::Id::MOVA:
+                for (std::size_t i = 0; i < 2; ++i) {
+                    if (!(op.dest_mask & (1 << i))) {
+                        continue;
+                    }
+                    for (std::size_t l = 0; l < LANES; ++l) {
+                        // TODO: Figure out how the rounding is done on hardware
+                        state.address_registers[i][l] = static_cast<s32>(src1[i].v[l]);
+                    }
+                }
+                break;
+            case OpCode::Id::CMP: {
+                using CompareOp = Instruction::Common::CompareOpType;
+                const auto compare_op = instr.common.compare_op;
+                bool supported = true;
+                for (std::size_t i = 0; i < 2; ++i) {
+                    const auto cmp = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+                    for (std::size_t l = 0; l < LANES; ++l) {
+                        const float a = src1[i].v[l];
+                        const float b = src2[i].v[l];
+                        bool& code = state.conditional_code[i][l];
+                        switch (cmp) {
+                        case CompareOp::Equal:
+                            code = a == b;
+                            break;
+                        case CompareOp::NotEqual:
+                            code = a != b;
+                            break;
+                        case CompareOp::LessThan:
+                            code = a < b;
+                            break;
+                        case CompareOp::LessEqual:
+                            code = a <= b;
+                            break;
+                        case CompareOp::GreaterThan:
+                            code = a > b;
+                            break;
+                        case CompareOp::GreaterEqual:
+                            code = a >= b;
+                            break;
+                        default:
+                            supported = false;
+                            break;
+                        }
+                    }
+                }
+                if (!supported) {
+                    // Let the scalar interpreter report the unknown compare mode.
+                    finish_scalar();
+                    return;
+                }
+                break;
+            }
+            default:
+                finish_scalar();
+                return;
+            }
+
+            if (op.opcode != OpCode::Id::MOVA && op.opcode != OpCode::Id::CMP) {
+                LaneVec4& dest = op.dest_is_output ? state.output[op.dest_index]
+                                                   : state.temporary[op.dest_index];
+                for (std::size_t i = 0; i < 4; ++i) {
+                    if (op.dest_mask & (1 << i)) {
+                        dest[i] = result[i];
+                    }
+                }
+            }
+        } else {
+            const auto do_call = [&] {
+                control.call_stack.push_back({
+                    .end_address =
+                        instr.flow_control.dest_offset + instr.flow_control.num_instructions,
+                    .return_address = program_counter + 1,
+                });
+                program_counter = instr.flow_control.dest_offset - 1;
+            };
+
+            const auto do_if = [&](bool condition) {
+                if (condition) {
+                    control.if_stack.push_back({
+                        .else_address = instr.flow_control.dest_offset,
+                        .end_address =
+                            instr.flow_control.dest_offset + instr.flow_control.num_instructions,
+                    });
+                } else {
+                    program_counter = instr.flow_control.dest_offset - 1;
+                }
+            };
+
+            const bool uniform_condition = uniforms.b[instr.flow_control.bool_uniform_id];
+
+            switch (op.opcode) {
+            case OpCode::Id::END:
+                state.Store(units);
+                return;
+
+            case OpCode::Id::NOP:
+                break;
+
+            case OpCode::Id::JMPU:
+                if (uniform_condition == !(instr.flow_control.num_instructions & 1)) {
+                    program_counter = instr.flow_control.dest_offset - 1;
+                }
+                break;
+
+            case OpCode::Id::CALL:
+                do_call();
+                break;
+
+            case OpCode::Id::CALLU:
+                if (uniform_condition) {
+                    do_call();
+                }
+                break;
+
+            case OpCode::Id::IFU:
+                do_if(uniform_condition);
+                break;
+
+            case OpCode::Id::JMPC:
+            case OpCode::Id::CALLC:
+            case OpCode::Id::IFC:
+            case OpCode::Id::BREAKC: {
+                const auto condition = EvaluateBatchCondition(instr.flow_control, state);
+                if (!condition) {
+                    finish_scalar();
+                    return;
+                }
+                if (op.opcode == OpCode::Id::JMPC) {
+                    if (*condition) {
+                        program_counter = instr.flow_control.dest_offset - 1;
+                    }
+                } else if (op.opcode == OpCode::Id::CALLC) {
+                    if (*condition) {
+                        do_call();
+                    }
+                } else if (op.opcode == OpCode::Id::IFC) {
+                    do_if(*condition);
+                } else {
+                    is_break = *condition;
+                }
+                break;
+            }
+
+            case OpCode::Id::LOOP: {
+                const Common::Vec4<u8>& loop_param = uniforms.i[instr.flow_control.int_uniform_id];
+                // The scalar interpreter saves aL after it has been set to the loop start value,
+                // which makes the saved value identical for every lane.
+                control.loop_stack.push_back({
+                    .entry_address = program_counter + 1,
+                    .end_address = instr.flow_control.dest_offset + 1,
+                    .loop_downcounter = loop_param.x,
+                    .address_increment = loop_param.z,
+                    .previous_aL = loop_param.y,
+                });
+                state.address_registers[2].fill(loop_param.y);
+                break;
+            }
+
+            case OpCode::Id::BREAK:
+                is_break = true;
+                break;
+
+            default:
+                // Geometry shader emission and unknown instructions
+                finish_scalar();
+                return;
+            }
+        }
+
+        ++program_counter;
+
+        CloseScopes(control, old_program_counter, is_break,
+                    [&state](const LoopStackElement& loop, bool restore_previous) {
+                        for (auto& aL : state.address_registers[2]) {
+                            aL += loop.address_increment;
+                            if (restore_previous) {
+                                aL = loop.previous_aL;
+                            }
+                        }
+                    });
+    }
+}
+
+InterpreterEngine::InterpreterEngine() = default;
+
+InterpreterEngine::~InterpreterEngine() = default;
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.entry_point = entry_point;
+
+    const u64 code_hash = setup.GetProgramCodeHash();
+    const u64 swizzle_hash = setup.GetSwizzleDataHash();
+
+    const u64 cache_key = Common::HashCombine(code_hash, swizzle_hash);
+    auto iter = cache.find(cache_key);
+    if (iter != cache.end()) {
+        setup.cached_shader = iter->second.get();
+    } else {
+        auto program = std::make_unique<DecodedProgram>();
+        DecodeProgram(setup, *program);
+        setup.cached_shader = program.get();
+        cache.emplace_hint(iter, cache_key, std::move(program));
+    }
 }
 
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
 
 void InterpreterEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
+    ASSERT(setup.cached_shader != nullptr);
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const auto* program = static_cast<const DecodedProgram*>(setup.cached_shader);
+    RunDecodedInterpreter(setup, *program, state,
+                          ControlState{.program_counter = setup.entry_point});
+}
+
+void InterpreterEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const {
+    ASSERT(setup.cached_shader != nullptr);
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
-    DebugData<false> dummy_debug_data;
-    RunInterpreter(setup, state, dummy_debug_data, setup.entry_point);
+    const auto* program = static_cast<const DecodedProgram*>(setup.cached_shader);
+    std::size_t offset = 0;
+    for (; offset + LANES <= states.size(); offset += LANES) {
+        RunBatchInterpreter(setup, *program, states.subspan(offset).first<LANES>());
+    }
+
+    // Pad the remaining invocations with copies of the last one
+    const std::size_t remaining = states.size() - offset;
+    if (remaining != 0) {
+        std::array<ShaderUnit, LANES> tail;
+        for (std::size_t l = 0; l < LANES; ++l) {
+            tail[l] = states[offset + std::min(l, remaining - 1)];
+        }
+        RunBatchInterpreter(setup, *program, tail);
+        std::copy_n(tail.begin(), remaining, states.begin() + offset);
+    }
 }
 
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
@@ -744,7 +1919,7 @@ DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
     // Setup input register table
     state.input.fill(Common::Vec4<f24>::AssignToAll(f24::Zero()));
     state.LoadInput(config, input);
-    RunInterpreter(setup, state, debug_data, setup.entry_point);
+    RunInterpreter(setup, state, debug_data, ControlState{.program_counter = setup.entry_point});
     return debug_data;
 }
 
@@ -5,12 +5,16 @@
 #include <cstring>
 #include <cassert>
 #include <climits>
+#include <cstdlib>
+#include <random>
 
 #include "libretro.h"
 #include "common/settings.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/loader/loader.h"
+#include "core/rewind_buffer.h"
 #include "common/file_util.h"
 #include "video_core/renderer_base.h"
 #include "core/frontend/emu_window.h"
@@ -23,11 +27,6 @@
 #include "file/file_path.h"
 #include "streams/file_stream.h"
 
-#include <boost/archive/binary_iarchive.hpp>
-#include <boost/archive/binary_oarchive.hpp>
-#include <boost/iostreams/device/array.hpp>
-#include <boost/iostreams/stream.hpp>
-
 static retro_environment_t environ_cb;
 static retro_video_refresh_t video_cb;
 static retro_audio_sample_t audio_cb;
@@ -38,6 +37,30 @@ static retro_input_state_t input_state_cb;
 static LibretroEmuWindow* emu_window = nullptr;
 static AudioCore::LibretroSink* audio_sink = nullptr;
 
+// Fraction of an audio sample not handed out yet, carried over to the next frame.
+static double pending_samples = 0.0;
+
+// Header of the states handed to the frontend. A standalone state carries the whole system.
+// A rewind state only refers to a state kept in the rewind buffer of this session, which is
+// used when the frontend guarantees that the same instance loads it back.
+struct StateHeader {
+    char magic[4];
+    uint32_t kind;
+    uint64_t session_id;
+    uint64_t rewind_id; // Identifier in the rewind buffer, for rewind states
+    uint64_t size;      // Bytes that follow the header, for standalone states
+};
+static_assert(sizeof(StateHeader) == 32, "StateHeader should be 32 bytes");
+
+static constexpr char state_magic[4] = {'C', 'Y', 'S', 'T'};
+enum : uint32_t { STATE_STANDALONE = 1, STATE_REWIND = 2 };
+
+// Identifies the loaded game, so that rewind states of another session are rejected.
+static uint64_t session_id = 0;
+
+// Largest standalone state saved in this session, including the ones that did not fit.
+static size_t largest_state_size = 0;
+
 static void setup_settings(const char* system_dir) {
     char citra_path[PATH_MAX];
     fill_pathname_join(citra_path, system_dir, "citra", sizeof(citra_path));
@@ -93,6 +116,8 @@ void retro_set_environment(retro_environment_t cb) {
         { "cytrus_model", "System Model; New 3DS|Old 3DS" },
         { "cytrus_audio_emulation", "Audio Emulation; HLE|LLE" },
         { "cytrus_direct_boot", "Direct Boot; enabled|disabled" },
+        { "cytrus_gpu_thread", "GPU Thread (Restart); disabled|enabled" },
+        { "cytrus_rewind_buffer", "Same-Instance State Buffer; disabled|128 MB|256 MB|512 MB" },
         { NULL, NULL },
     };
 
@@ -179,7 +204,7 @@ void retro_get_system_av_info(struct retro_system_av_info *info) {
     info->geometry.max_height = 480;
     info->geometry.aspect_ratio = 400.0f / 480.0f;
 
-    info->timing.fps = 60.0;
+    info->timing.fps = SCREEN_REFRESH_RATE;
     info->timing.sample_rate = 32768.0;
 }
 
@@ -188,6 +213,7 @@ void retro_set_controller_port_device(unsigned port, unsigned device) {
 
 void retro_reset(void) {
     Core::System::GetInstance().Reset();
+    pending_samples = 0.0;
 }
 
 static void update_variables() {
@@ -216,6 +242,28 @@ static void update_variables() {
         if (strcmp(var.value, "HLE") == 0) Settings::values.audio_emulation.SetValue(Settings::AudioEmulation::HLE);
         else Settings::values.audio_emulation.SetValue(Settings::AudioEmulation::LLE);
     }
+
+    var.key = "cytrus_gpu_thread";
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+        Settings::values.use_gpu_thread.SetValue(strcmp(var.value, "enabled") == 0);
+    }
+
+    var.key = "cytrus_rewind_buffer";
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+        // "disabled" parses as 0, which turns the buffer off.
+        Settings::values.rewind_buffer_size.SetValue(strtoul(var.value, nullptr, 10));
+        Core::System::GetInstance().RewindBuffer().ApplyBudget();
+    }
+}
+
+static bool is_same_instance_state() {
+#ifdef RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT
+    int context = RETRO_SAVESTATE_CONTEXT_NORMAL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT, &context)) {
+        return context == RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE;
+    }
+#endif
+    return false;
 }
 
 static void update_input() {
@@ -260,7 +308,7 @@ void retro_run(void) {
 
     Core::System& system = Core::System::GetInstance();
     if (system.IsPoweredOn()) {
-        (void)system.RunLoop();
+        (void)system.RunFrame();
     }
 
     if (emu_window) {
@@ -273,25 +321,60 @@ void retro_run(void) {
     }
 
     if (audio_sink) {
-        static constexpr size_t samples_per_frame = 32768 / 60;
-        s16 samples[samples_per_frame * 2]; // * 2 for safety
-        audio_sink->PullSamples(samples, samples_per_frame);
-        audio_batch_cb(samples, samples_per_frame);
+        // Exactly one emulated frame ran, so hand out one frame worth of audio. The fractional
+        // part is carried over so that the long term rate matches the sink.
+        static constexpr double samples_per_frame = 32768.0 / SCREEN_REFRESH_RATE;
+        pending_samples += samples_per_frame;
+        const size_t num_samples = static_cast<size_t>(pending_samples);
+        pending_samples -= num_samples;
+
+        s16 samples[(static_cast<size_t>(samples_per_frame) + 1) * 2]; // * 2 for stereo
+        audio_sink->PullSamples(samples, num_samples);
+        audio_batch_cb(samples, num_samples);
     }
 }
 
 size_t retro_serialize_size(void) {
-    // 3DS states can be large. 64MB should be a safe upper bound for most games.
-    return 64 * 1024 * 1024;
+    // Standalone states leave out pages that are all zeroes and are compressed, so they usually
+    // stay well below 64MB. Computing the exact size would mean saving a state on every call. A
+    // game that fills most of the 256MB of FCRAM with data that does not compress can still
+    // exceed it. retro_serialize fails in that case, and the size reported from then on covers
+    // that state with some headroom, so that the frontend can retry with a larger buffer.
+    constexpr size_t min_size = 64 * 1024 * 1024;
+    return std::max(min_size, sizeof(StateHeader) + largest_state_size + largest_state_size / 8);
 }
 
 bool retro_serialize(void *data, size_t len) {
+    if (len < sizeof(StateHeader)) {
+        return false;
+    }
+
     try {
-        namespace io = boost::iostreams;
-        io::array_sink sink((char*)data, len);
-        io::stream<io::array_sink> os(sink);
-        boost::archive::binary_oarchive ar(os);
-        ar & Core::System::GetInstance();
+        auto& rewind_buffer = Core::System::GetInstance().RewindBuffer();
+        StateHeader header{};
+        memcpy(header.magic, state_magic, sizeof(header.magic));
+        header.session_id = session_id;
+
+        if (rewind_buffer.IsEnabled() && is_same_instance_state()) {
+            // The state stays in the rewind buffer, which only stores the pages changed since
+            // its keyframe, so nothing of the system has to be copied to the frontend.
+            header.kind = STATE_REWIND;
+            header.rewind_id = rewind_buffer.Capture();
+            memcpy(data, &header, sizeof(header));
+            return true;
+        }
+
+        const std::vector<u8> state = rewind_buffer.SaveStandalone();
+        largest_state_size = std::max(largest_state_size, state.size());
+        if (state.size() > len - sizeof(header)) {
+            LOG_ERROR(Core, "retro_serialize failed: state of {} bytes does not fit in {} bytes",
+                      state.size(), len - sizeof(header));
+            return false;
+        }
+        header.kind = STATE_STANDALONE;
+        header.size = state.size();
+        memcpy(data, &header, sizeof(header));
+        memcpy(static_cast<u8*>(data) + sizeof(header), state.data(), state.size());
         return true;
     } catch (const std::exception& e) {
         LOG_ERROR(Core, "retro_serialize failed: {}", e.what());
@@ -300,12 +383,32 @@ bool retro_serialize(void *data, size_t len) {
 }
 
 bool retro_unserialize(const void *data, size_t len) {
+    StateHeader header;
+    if (len < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, state_magic, sizeof(header.magic)) != 0) {
+        LOG_ERROR(Core, "retro_unserialize failed: not a Cytrus state");
+        return false;
+    }
+
     try {
-        namespace io = boost::iostreams;
-        io::array_source source((const char*)data, len);
-        io::stream<io::array_source> is(source);
-        boost::archive::binary_iarchive ar(is);
-        ar & Core::System::GetInstance();
+        auto& rewind_buffer = Core::System::GetInstance().RewindBuffer();
+        if (header.kind == STATE_REWIND) {
+            if (header.session_id != session_id || !rewind_buffer.Restore(header.rewind_id)) {
+                LOG_ERROR(Core, "retro_unserialize failed: state is not in the rewind buffer");
+                return false;
+            }
+            return true;
+        }
+
+        if (header.kind != STATE_STANDALONE || header.size > len - sizeof(header)) {
+            LOG_ERROR(Core, "retro_unserialize failed: invalid state header");
+            return false;
+        }
+        rewind_buffer.LoadStandalone(
+            std::span{static_cast<const u8*>(data) + sizeof(header), header.size});
         return true;
     } catch (const std::exception& e) {
         LOG_ERROR(Core, "retro_unserialize failed: {}", e.what());
@@ -342,6 +445,8 @@ bool retro_load_game(const struct retro_game_info *game) {
     auto status = system.Load(*emu_window, game->path);
 
     if (status == Core::System::ResultStatus::Success) {
+        std::random_device random_device;
+        session_id = (static_cast<uint64_t>(random_device()) << 32) | random_device();
         system.DSP().SetSink(AudioCore::SinkType::Libretro, "");
         audio_sink = dynamic_cast<AudioCore::LibretroSink*>(&system.DSP().GetSink());
         return true;
@@ -357,6 +462,8 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info *i
 void retro_unload_game(void) {
     Core::System::GetInstance().Shutdown();
     audio_sink = nullptr;
+    pending_samples = 0.0;
+    largest_state_size = 0;
 }
 
 unsigned retro_get_region(void) {